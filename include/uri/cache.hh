@@ -0,0 +1,109 @@
+/* -*- Mode: c++ -*- */
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __URI_CACHE__
+#define __URI_CACHE__
+
+#include "uri/uri.hh"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class UriCacheImpl;
+
+/**
+ * Bounded, sharded, thread-safe cache of parsed URIs keyed by the input string
+ *
+ * Entries are immutable and shared; callers that need to modify a result take a copy with
+ * parse().  Each shard is protected by its own mutex and evicts with the CLOCK (second chance)
+ * algorithm once full.
+ *
+ * @code
+ *   static UriCache cache( 65536 );
+ *   std::shared_ptr< const Uri > uri = cache.get( request );
+ *   std::shared_ptr< const Uri > origin = cache.prefix( request ); // scheme://authority only
+ * @endcode
+ */
+class UriCache {
+ public:
+  struct Statistics {
+    uint64_t hits;      ///< lookups answered from the cache
+    uint64_t misses;    ///< lookups that parsed the input
+    uint64_t evictions; ///< entries dropped to make room
+    uint64_t entries;   ///< entries currently held
+  };
+
+  /**
+   * @brief Cache constructor
+   * @param capacity maximum number of entries (rounded up to a multiple of the shard count)
+   * @param shards number of independently locked shards
+   */
+  explicit UriCache( size_t capacity = 4096, size_t shards = 16 );
+  ~UriCache( );
+
+  UriCache( const UriCache & ) = delete;
+  UriCache &operator=( const UriCache & ) = delete;
+
+  /**
+   * @brief Get the parsed form of a URI, parsing and caching it on a miss
+   * @param uri URI to parse
+   * @throw runtime error on parsing or memory allocation (failures are not cached)
+   * @return shared, immutable URI object
+   */
+  std::shared_ptr< const Uri > get( const std::string &uri ) noexcept( false );
+
+  /**
+   * @brief Get the parsed form of the scheme and authority of a URI ("scheme://authority")
+   * @param uri URI whose prefix to parse
+   * @throw runtime error on parsing or memory allocation
+   * @return shared, immutable URI object for the prefix
+   */
+  std::shared_ptr< const Uri > prefix( const std::string &uri ) noexcept( false );
+
+  /**
+   * @brief Get a modifiable copy of the parsed form of a URI
+   * @param uri URI to parse
+   * @throw runtime error on parsing or memory allocation
+   * @return URI object owned by the caller
+   */
+  Uri *parse( const std::string &uri ) noexcept( false ) { return get( uri )->clone( ); }
+
+  /**
+   * @brief Get the cache statistics
+   * @return counters, summed over the shards
+   */
+  Statistics statistics( ) const;
+
+  /**
+   * @brief Drop every entry (statistics are kept)
+   */
+  void clear( );
+
+ private:
+  std::unique_ptr< UriCacheImpl > impl;
+};
+
+#endif
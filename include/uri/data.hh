@@ -0,0 +1,145 @@
+/* -*- Mode: c++ -*- */
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __URI_DATA__
+#define __URI_DATA__
+
+#include "uri/view.hh"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * RFC 2397 "data" URI
+ *
+ * The URI is split in place: the media type, its parameters and the still-encoded payload are
+ * views into the caller's buffer.  decode() writes the payload (base64 or percent-encoded)
+ * into a caller-provided buffer; base64 is decoded 16 characters at a time on x86 CPUs with
+ * SSSE3 (detected at run time) and four at a time otherwise.
+ *
+ * @code
+ *   DataUri image;
+ *   if ( DataUri::parse( src, image ) && image.base64( ) ) {
+ *     std::vector< char > pixels( image.decodedSize( ) );
+ *     pixels.resize( image.decode( pixels.data( ), pixels.size( ) ) );
+ *   }
+ * @endcode
+ */
+class DataUri {
+ public:
+  typedef UriView::Span            Span;
+  typedef std::pair< Span, Span >  Parameter;
+  typedef std::vector< Parameter > Parameters;
+
+  static constexpr size_t INVALID = static_cast< size_t >( -1 ); ///< decode() failure
+
+  DataUri( )
+    : isBase64( false ) {}
+
+  /**
+   * @brief Split a "data:" URI
+   * @param data URI string
+   * @param size URI length
+   * @param uri destination
+   * @return true on success, false if the input is not a data URI
+   */
+  static bool parse( const char *data, size_t size, DataUri &uri );
+
+  static bool parse( const std::string &data, DataUri &uri ) {
+    return parse( data.data( ), data.size( ), uri );
+  }
+
+  static bool parse( std::string &&, DataUri & ) = delete; ///< the views would dangle
+
+  /**
+   * @brief Get the media type ("text/plain" when the URI leaves it out)
+   * @return media type, e.g. "image/png"
+   */
+  Span mediaType( ) const { return type; }
+
+  /**
+   * @brief Get the media type parameters (e.g. charset), in order of appearance
+   * @return name/value pairs
+   */
+  const Parameters &parameters( ) const { return params; }
+
+  /**
+   * @brief Look up a media type parameter
+   * @param name parameter name (case-insensitive)
+   * @return parameter value, absent if the parameter is not given
+   */
+  Span parameter( const std::string &name ) const;
+
+  /**
+   * @brief Check for the ";base64" encoding marker
+   * @return true if the payload is base64 encoded
+   */
+  bool base64( ) const { return isBase64; }
+
+  /**
+   * @brief Get the encoded payload
+   * @return payload, still base64 or percent-encoded
+   */
+  Span payload( ) const { return body; }
+
+  /**
+   * @brief Get an upper bound of the decoded payload size
+   * @return byte count to provide to decode()
+   */
+  size_t decodedSize( ) const { return isBase64 ? ( body.size + 3 ) / 4 * 3 : body.size; }
+
+  /**
+   * @brief Decode the payload
+   * @param out output buffer
+   * @param capacity output buffer size; decodedSize() is always sufficient
+   * @return decoded length, or INVALID on malformed base64 or insufficient capacity
+   */
+  size_t decode( char *out, size_t capacity ) const;
+
+  /**
+   * @brief Decode the payload into a string
+   * @throw runtime error on malformed base64
+   * @return decoded payload
+   */
+  std::string decode( ) const noexcept( false );
+
+  /**
+   * @brief Decode base64 text
+   * @param data base64 text (ASCII whitespace is skipped, padding is optional)
+   * @param size text length
+   * @param out output buffer of at least ( size + 3 ) / 4 * 3 bytes
+   * @return decoded length, or INVALID on malformed input
+   */
+  static size_t decodeBase64( const char *data, size_t size, char *out );
+
+ private:
+  Span       type;
+  Parameters params;
+  Span       body;
+  bool       isBase64;
+};
+
+#endif
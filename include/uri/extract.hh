@@ -0,0 +1,98 @@
+/* -*- Mode: c++ -*- */
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __URI_EXTRACT__
+#define __URI_EXTRACT__
+
+#include "uri/uri.hh"
+#include "uri/view.hh"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Extract URIs from free text
+ *
+ * Candidates are anchored on `scheme://`, a known opaque `scheme:` (mailto, tel, urn, ...)
+ * or `www.`; anchors are located with a vectorized scan.  Each candidate is extended over
+ * RFC 3986 characters, keeping balanced brackets and dropping trailing punctuation, and is
+ * then split with UriView.
+ */
+class UriExtractor {
+ public:
+  /**
+   * Extracted URI; views point into the scanned text
+   */
+  struct Match {
+    size_t  offset; ///< byte offset of the URI within the text
+    size_t  length; ///< URI length
+    bool    www;    ///< candidate was anchored on "www." and has no scheme
+    UriView view;   ///< URI components
+
+    /**
+     * @brief Parse the extracted URI ("http://" is assumed for "www." candidates)
+     * @throw runtime error on parsing or memory allocation
+     * @return URI object
+     */
+    Uri *parse( ) const noexcept( false ) {
+      std::string uri = view.uri.str( );
+      return Uri::parse( www ? "http://" + uri : uri );
+    }
+  };
+
+  /**
+   * Match callback; return false to stop the scan
+   */
+  typedef std::function< bool( const Match & ) > Callback;
+
+  /**
+   * @brief Scan text for URIs
+   * @param data text
+   * @param size text length
+   * @param callback invoked for every URI, in order of appearance
+   * @return number of URIs reported
+   */
+  static size_t extract( const char *data, size_t size, const Callback &callback );
+
+  /**
+   * @brief Scan text for URIs
+   * @param text text; must outlive the returned matches
+   * @return URIs, in order of appearance
+   */
+  static std::vector< Match > extract( const std::string &text ) {
+    std::vector< Match > matches;
+
+    extract( text.data( ), text.size( ), [&matches]( const Match &match ) {
+      matches.push_back( match );
+      return true;
+    } );
+    return matches;
+  }
+
+  static std::vector< Match > extract( std::string && ) = delete; ///< the views would dangle
+};
+
+#endif
@@ -0,0 +1,106 @@
+/* -*- Mode: c++ -*- */
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __URI_FILTER__
+#define __URI_FILTER__
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Compiled set of query keys to strip from URIs
+ *
+ * Keys are matched exactly or by prefix against the decoded query field name.  Filtering
+ * rewrites the query of a raw URI string in one pass; the pairs that are kept, and everything
+ * outside the query, are copied byte for byte.
+ *
+ * @code
+ *   QueryFilter tracking;
+ *   tracking.prefix( "utm_" ).key( "fbclid" ).key( "gclid" );
+ *   std::string link = "https://example.com/a?utm_source=x&id=%41&fbclid=y#top";
+ *   tracking.apply( link ); // https://example.com/a?id=%41#top
+ * @endcode
+ */
+class QueryFilter {
+ public:
+  QueryFilter( );
+
+  /**
+   * @brief Strip fields whose name is exactly @p name
+   * @param name decoded field name
+   * @return this filter
+   */
+  QueryFilter &key( const std::string &name );
+
+  /**
+   * @brief Strip fields whose name starts with @p name
+   * @param name decoded field name prefix
+   * @return this filter
+   */
+  QueryFilter &prefix( const std::string &name );
+
+  /**
+   * @brief Check a raw (possibly percent-encoded) field name against the filter
+   * @param name field name
+   * @param size name length
+   * @return true if the field is stripped
+   */
+  bool matches( const char *name, size_t size ) const;
+
+  /**
+   * @brief Filter the query of a URI into an output buffer
+   * @param data URI string
+   * @param size URI length
+   * @param out output buffer of at least @p size bytes; may be @p data for in-place filtering
+   * @return length of the filtered URI
+   */
+  size_t apply( const char *data, size_t size, char *out ) const;
+
+  /**
+   * @brief Filter the query of a URI in place
+   * @param uri URI string
+   * @return true if any field was stripped
+   */
+  bool apply( std::string &uri ) const;
+
+ private:
+  static constexpr uint8_t EXACT  = 0x01;
+  static constexpr uint8_t PREFIX = 0x02;
+
+  struct Node {
+    std::vector< std::pair< unsigned char, uint32_t > > children; ///< sorted by character
+    uint8_t                                             flags;
+  };
+
+  std::vector< Node > nodes;
+
+  void     insert( const std::string &name, uint8_t flag );
+  bool     lookup( const char *name, size_t size ) const;
+  uint32_t child( uint32_t node, unsigned char ch ) const;
+};
+
+#endif
@@ -0,0 +1,131 @@
+/* -*- Mode: c++ -*- */
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __URI_FORM__
+#define __URI_FORM__
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * Incremental application/x-www-form-urlencoded decoder
+ *
+ * Input may be fed in chunks split at any byte, including inside a percent escape.  Each
+ * name/value pair is decoded (same percent rules as Uri::unescape) and handed to the callback
+ * as soon as its terminating '&' (or the end of input) is seen, so memory is bounded by the
+ * largest single field rather than by the body.
+ */
+class FormDecoder {
+ public:
+  /**
+   * Pair callback; return false to stop decoding
+   */
+  typedef std::function< bool( const std::string &, const std::string & ) > Callback;
+
+  /**
+   * @brief Decoder constructor
+   * @param callback receives each decoded name/value pair
+   * @param limit maximum decoded length of a single name or value, 0 for no limit
+   * @param plus decode '+' as a space (HTML form encoding)
+   */
+  explicit FormDecoder( Callback callback, size_t limit = 0, bool plus = true );
+
+  /**
+   * @brief Decode the next chunk of the body
+   * @param data chunk
+   * @param size chunk length
+   * @return true on success, false if a field exceeded the limit or the callback stopped
+   */
+  bool feed( const char *data, size_t size );
+
+  bool feed( const std::string &chunk ) { return feed( chunk.data( ), chunk.size( ) ); }
+
+  /**
+   * @brief Signal the end of the body, flushing the last pair
+   * @return true on success, false on failure
+   */
+  bool finish( );
+
+  /**
+   * @brief Reset the decoder for a new body
+   */
+  void reset( );
+
+ private:
+  Callback    callback;
+  size_t      limit;
+  bool        plus;
+  bool        failed;
+  bool        inValue;
+  int         pending; ///< hex digits of a percent escape still to come (0 when none)
+  uint8_t     octet;   ///< percent escape value so far
+  std::string key;
+  std::string value;
+
+  bool append( const char *data, size_t size );
+  bool pair( );
+};
+
+/**
+ * Incremental application/x-www-form-urlencoded encoder
+ *
+ * Pairs are escaped with Uri::ENCODE_FORM into an internal buffer that is handed to the sink
+ * whenever it fills, and on flush() / destruction.
+ */
+class FormEncoder {
+ public:
+  typedef std::function< void( const char *, size_t ) > Sink;
+
+  /**
+   * @brief Encoder constructor
+   * @param sink receives encoded output
+   * @param capacity buffer size before output is handed to the sink
+   */
+  explicit FormEncoder( Sink sink, size_t capacity = 4096 );
+  ~FormEncoder( );
+
+  /**
+   * @brief Encode a name/value pair
+   * @param key field name
+   * @param value field value
+   */
+  void add( const std::string &key, const std::string &value );
+
+  /**
+   * @brief Hand any buffered output to the sink
+   */
+  void flush( );
+
+ private:
+  Sink        sink;
+  size_t      capacity;
+  bool        first;
+  std::string buffer;
+
+  void encode( const std::string &value );
+};
+
+#endif
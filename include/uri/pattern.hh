@@ -0,0 +1,112 @@
+/* -*- Mode: c++ -*- */
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __URI_PATTERN__
+#define __URI_PATTERN__
+
+#include "uri/uri.hh"
+#include "uri/view.hh"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class UriPatternSetImpl;
+
+/**
+ * Set of URI glob patterns matched together in a single pass
+ *
+ * Patterns have the form `[scheme://]host[/path][?query]`, where `*` matches any run of
+ * characters within a component and `\` escapes the next character.  A component left out
+ * of the pattern (or given as a lone `*`) is unconstrained.  Scheme and host compare
+ * case-insensitively; path and query compare against the raw, still-escaped bytes.
+ *
+ * Literal globs are found through a hash map and host suffixes such as `*.example.com` through
+ * a trie of reversed labels.  The remaining globs of each component form one automaton that is
+ * determinized lazily into a size-bounded cache per thread, so matching walks each component
+ * of the URI once regardless of the number of patterns.
+ *
+ * match() never modifies the set and may run concurrently from any number of threads; add()
+ * must not run concurrently with any other call.
+ *
+ * @code
+ *   UriPatternSet policy;
+ *   size_t admin = policy.add( "*.example.com/admin*" );
+ *   size_t login = policy.add( "https://login.example.com/?next=*" );
+ *   std::vector< size_t > ids;
+ *   policy.match( "https://www.example.com/admin/users", ids ); // ids == { admin }
+ * @endcode
+ */
+class UriPatternSet {
+ public:
+  UriPatternSet( );
+  ~UriPatternSet( );
+
+  UriPatternSet( const UriPatternSet & ) = delete;
+  UriPatternSet &operator=( const UriPatternSet & ) = delete;
+
+  /**
+   * @brief Add a pattern to the set
+   * @note Will throw a runtime error if the pattern is malformed
+   * @param pattern glob pattern
+   * @return pattern identifier (sequential, starting at 0)
+   */
+  size_t add( const std::string &pattern ) noexcept( false );
+
+  /**
+   * @brief Get the number of patterns in the set
+   * @return pattern count
+   */
+  size_t size( ) const;
+
+  /**
+   * @brief Match a URI view against every pattern
+   * @param view URI components
+   * @param ids receives the matching pattern identifiers, in ascending order
+   * @return true if any pattern matched
+   */
+  bool match( const UriView &view, std::vector< size_t > &ids ) const;
+
+  /**
+   * @brief Match a URI string against every pattern, without copying its components
+   * @param uri URI string
+   * @param ids receives the matching pattern identifiers, in ascending order
+   * @return true if any pattern matched
+   */
+  bool match( const std::string &uri, std::vector< size_t > &ids ) const;
+
+  /**
+   * @brief Match a parsed URI against every pattern
+   * @param uri Uri object
+   * @param ids receives the matching pattern identifiers, in ascending order
+   * @return true if any pattern matched
+   */
+  bool match( const Uri &uri, std::vector< size_t > &ids ) const;
+
+ private:
+  std::unique_ptr< UriPatternSetImpl > impl;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/* -*- Mode: c++ -*- */
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __URI_SURT__
+#define __URI_SURT__
+
+#include "uri/view.hh"
+
+#include <string>
+#include <vector>
+
+/**
+ * SURT (Sort-friendly URI Reordering Transform) keys
+ *
+ * The host is lowercased and its labels reversed and comma separated, so that byte-wise
+ * ordering of the keys groups a site's pages together:
+ *
+ *   http://www.Example.com:8080/path?query#frag  ->  com,example,www:8080)/path?query
+ *
+ * http and https share the key space and drop the scheme; other schemes keep it as a
+ * "scheme:" prefix.  User info, default ports and fragments are dropped, an empty path
+ * becomes "/" and IP addresses are not reversed.
+ */
+class Surt {
+ public:
+  /**
+   * @brief Write the key of a split URI
+   * @param view URI components
+   * @param out output buffer, may be null when @p capacity is 0
+   * @param capacity output buffer size
+   * @return key length; the key was only written completely if this is <= capacity
+   */
+  static size_t key( const UriView &view, char *out, size_t capacity );
+
+  /**
+   * @brief Write the key of a URI string
+   * @param data URI string
+   * @param size URI length
+   * @param out output buffer
+   * @param capacity output buffer size; size + 4 is always sufficient
+   * @return key length; the key was only written completely if this is <= capacity
+   */
+  static size_t key( const char *data, size_t size, char *out, size_t capacity );
+
+  /**
+   * @brief Get the key of a URI string
+   * @param uri URI string
+   * @return SURT key
+   */
+  static std::string key( const std::string &uri );
+
+  /**
+   * @brief Generate the keys of many URIs into one contiguous buffer
+   * @param uris URI strings
+   * @param buffer receives the keys back to back (replaced)
+   * @param offsets receives uris.size() + 1 offsets; key i is [offsets[i], offsets[i + 1])
+   */
+  static void keys( const std::vector< std::string > &uris,
+                    std::string &                     buffer,
+                    std::vector< size_t > &           offsets );
+};
+
+#endif
@@ -0,0 +1,176 @@
+/* -*- Mode: c++ -*- */
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __URI_TEMPLATE__
+#define __URI_TEMPLATE__
+
+#include "uri/uri.hh"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * RFC 6570 URI template (level 4)
+ *
+ * The template is compiled once into an expansion program of pre-escaped literals and
+ * expressions; expansion then writes straight into a presized output buffer.
+ *
+ * @code
+ *   UriTemplate tmpl( "https://{host}/v1/users/{id}{?fields*}" );
+ *   UriTemplate::Variables vars = { { "host", "api.example.com" },
+ *                                   { "id", "42" },
+ *                                   { "fields", UriTemplate::Value::List{ "name", "email" } } };
+ *   tmpl.expand( vars ); // https://api.example.com/v1/users/42?fields=name&fields=email
+ * @endcode
+ */
+class UriTemplate {
+ public:
+  /**
+   * Template variable value; a string, a list of strings or an associative array
+   */
+  class Value {
+   public:
+    typedef std::vector< std::string >                           List;
+    typedef std::vector< std::pair< std::string, std::string > > Map;
+
+    enum Type { UNDEFINED, STRING, LIST, MAP };
+
+    Value( )
+      : kind( UNDEFINED ) {}
+    Value( const char *value )
+      : kind( STRING )
+      , string( value ) {}
+    Value( std::string value )
+      : kind( STRING )
+      , string( std::move( value ) ) {}
+    Value( List value )
+      : kind( LIST )
+      , list( std::move( value ) ) {}
+    Value( Map value )
+      : kind( MAP )
+      , map( std::move( value ) ) {}
+
+    Type               type( ) const { return kind; }
+    const std::string &str( ) const { return string; }
+    const List &       items( ) const { return list; }
+    const Map &        pairs( ) const { return map; }
+
+    /**
+     * @brief Check whether the value is "defined" per RFC 6570 section 2.3
+     * @return false for undefined values, empty lists and empty associative arrays
+     */
+    bool defined( ) const {
+      switch ( kind ) {
+        case STRING: return true;
+        case LIST: return !list.empty( );
+        case MAP: return !map.empty( );
+        default: return false;
+      }
+    }
+
+   private:
+    Type        kind;
+    std::string string;
+    List        list;
+    Map         map;
+  };
+
+  typedef std::unordered_map< std::string, Value > Variables;
+
+  /**
+   * @brief Compile a URI template
+   * @note Will throw a runtime error if the template is malformed
+   * @param tmpl template string
+   */
+  explicit UriTemplate( const std::string &tmpl ) noexcept( false );
+
+  /**
+   * @brief Get the variable names referenced by the template, in index order
+   * @return variable names
+   */
+  const std::vector< std::string > &variables( ) const { return names; }
+
+  /**
+   * @brief Look up the index of a template variable
+   * @param name variable name
+   * @return variable index, or -1 if the template does not reference it
+   */
+  int variable( const std::string &name ) const;
+
+  /**
+   * @brief Expand the template
+   * @param vars variable values by name
+   * @return expanded URI string
+   */
+  std::string expand( const Variables &vars ) const;
+
+  /**
+   * @brief Expand the template, appending to an output buffer
+   * @param vars variable values by name
+   * @param out output buffer
+   * @return number of bytes appended
+   */
+  size_t expand( const Variables &vars, std::string &out ) const;
+
+  /**
+   * @brief Expand the template from values bound by variable index (see variable())
+   * @param values values, indexed as variables(); missing trailing entries are undefined
+   * @param out output buffer
+   * @return number of bytes appended
+   */
+  size_t expand( const std::vector< Value > &values, std::string &out ) const;
+
+  /**
+   * @brief Expand the template into a parsed URI
+   * @param vars variable values by name
+   * @throw runtime error on parsing or memory allocation
+   * @return URI object
+   */
+  Uri *expandUri( const Variables &vars ) const noexcept( false );
+
+ private:
+  struct VarSpec {
+    size_t index;   ///< variable index (names)
+    size_t prefix;  ///< prefix modifier length, 0 for none
+    bool   explode; ///< explode modifier
+  };
+
+  struct Instruction {
+    bool                   expression; ///< expression (true) or literal text (false)
+    char                   op;         ///< expression operator, 0 for simple string expansion
+    std::string            literal;    ///< pre-escaped literal text
+    std::vector< VarSpec > varspecs;   ///< expression variables
+  };
+
+  std::vector< Instruction > program;
+  std::vector< std::string > names;
+  size_t                     literalSize;
+
+  size_t run( const Value *const *values, std::string &out ) const;
+};
+
+#endif
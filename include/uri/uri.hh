@@ -46,10 +46,32 @@ class Uri {
   static constexpr const char *QUERY    = "query";
   static constexpr const char *URI      = "uri";
 
+  /**
+   * Percent-encoding sets; each names the characters escaped when writing a component
+   */
+  enum EncodeSet {
+    ENCODE_DEFAULT,      ///< legacy Uri::escape( value ) set
+    ENCODE_PATH,         ///< whole path ("/" kept)
+    ENCODE_PATH_SEGMENT, ///< single path segment ("/" escaped)
+    ENCODE_QUERY,        ///< query value ("&", "+" and "#" escaped, "=" kept)
+    ENCODE_QUERY_KEY,    ///< query name (as ENCODE_QUERY, "=" escaped too)
+    ENCODE_FRAGMENT,     ///< fragment
+    ENCODE_USERINFO,     ///< user name or password
+    ENCODE_FORM,         ///< application/x-www-form-urlencoded (space written as "+")
+  };
+
   static Uri *parse( const std::string &uri ) noexcept( false );
+  static Uri *parse( const std::string &uri, bool strict ) noexcept( false );
+  static bool validate( const std::string &uri, std::string *reason = nullptr );
 
   virtual ~Uri( ) = default;
 
+  /**
+   * @brief Copy the URI
+   * @return independent copy of this URI
+   */
+  virtual Uri *clone( ) const = 0;
+
   virtual std::string getComponent( const std::string & ) const        = 0;
   virtual std::string setComponent( const std::string &, std::string ) = 0;
 
@@ -163,30 +185,9 @@ class Uri {
    * @param value URI value
    * @return normalized / escaped value
    */
-  static std::string escape( const std::string &value ) {
-    std::stringstream ss;
+  static std::string escape( const std::string &value ) { return escape( value, ENCODE_DEFAULT ); }
 
-    for ( auto ch : value ) {
-      switch ( ch ) { // clang-format off
-        case ':': case '/': case '?': case '#': case '[': case ']':
-        case '@': case '%': case '!': case '$': case '&': case '\'':
-        case '(': case ')': case '*': case '+': case ',': case ';':
-        case ' ': case '=': {
-          // clang-format on
-          ss << '%'                                                     //
-             << std::hex << std::uppercase << ( ( ( ch ) &0xF0 ) >> 4 ) //
-             << std::hex << std::uppercase << ( ( ( ch ) &0x0F ) >> 0 );
-          break;
-        }
-        default: {
-          ss << ch;
-          break;
-        }
-      }
-    }
-
-    return ss.str( );
-  }
+  static std::string escape( const std::string &value, EncodeSet set );
 
   /* - * - * - * - * - * - * - * - * - * - * - * - * - * - */
 
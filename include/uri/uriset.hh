@@ -0,0 +1,182 @@
+/* -*- Mode: c++ -*- */
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __URI_URISET__
+#define __URI_URISET__
+
+#include "uri/uri.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/**
+ * Immutable, compressed, sorted set of URIs
+ *
+ * URIs are grouped by their scheme and authority ("scheme://user@host:port"); each group keeps
+ * the rest of its URIs (path, query and fragment) sorted and front-coded in blocks of BLOCK
+ * entries, every block starting with one entry stored in full.  Entries also share their
+ * common suffix with the previous entry (e.g. ".html"), so only the differing middle is
+ * stored.  Lookups binary search the groups and then the block heads, and decode at most one
+ * block.
+ *
+ * Iteration and scans visit groups in key order and the URIs of a group in order.
+ *
+ * @code
+ *   UriSet::Builder builder;
+ *   builder.add( "https://example.com/a" );
+ *   builder.add( "https://example.com/b?x=1" );
+ *   UriSet seen = builder.build( );
+ *   seen.contains( "https://example.com/a" );                  // true
+ *   seen.scan( "https://example.com/", []( const std::string &uri ) { return true; } );
+ * @endcode
+ */
+class UriSet {
+ public:
+  static constexpr size_t BLOCK = 16; ///< entries per front-coded block
+
+  /**
+   * Collects URIs for a set
+   */
+  class Builder {
+   public:
+    /**
+     * @brief Add a URI (duplicates are dropped on build)
+     * @param uri URI string
+     */
+    void add( const std::string &uri ) { uris.push_back( uri ); }
+
+    /**
+     * @brief Add a parsed URI
+     * @param uri Uri object
+     */
+    void add( Uri &uri ) { uris.push_back( uri.toString( ) ); }
+
+    /**
+     * @brief Build the set; the builder is left empty
+     * @return compressed set
+     */
+    UriSet build( );
+
+   private:
+    std::vector< std::string > uris;
+  };
+
+  /**
+   * Forward iterator decoding the URIs in order
+   */
+  class const_iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef std::string               value_type;
+    typedef std::ptrdiff_t            difference_type;
+    typedef const std::string *       pointer;
+    typedef const std::string &       reference;
+
+    const std::string &operator*( ) const { return current; }
+    const std::string *operator->( ) const { return &current; }
+    const_iterator &   operator++( );
+    bool operator==( const const_iterator &other ) const { return entry == other.entry; }
+    bool operator!=( const const_iterator &other ) const { return entry != other.entry; }
+
+    /**
+     * @brief Parse the current URI
+     * @throw runtime error on parsing or memory allocation
+     * @return URI object
+     */
+    Uri *parse( ) const noexcept( false ) { return Uri::parse( current ); }
+
+   private:
+    friend class UriSet;
+
+    const UriSet *set;
+    size_t        group;
+    size_t        entry;
+    size_t        offset;
+    std::string   tail;
+    std::string   current;
+
+    const_iterator( const UriSet *set, size_t group, size_t entry );
+    void load( );
+  };
+
+  UriSet( );
+
+  /**
+   * @brief Get the number of URIs in the set
+   * @return URI count
+   */
+  size_t size( ) const { return groupStart.back( ); }
+
+  bool empty( ) const { return size( ) == 0; }
+
+  /**
+   * @brief Check for a URI
+   * @param uri URI string
+   * @return true if the set holds the URI
+   */
+  bool contains( const std::string &uri ) const;
+
+  /**
+   * @brief Visit every URI that starts with a prefix (e.g. "https://example.com/docs/")
+   * @param prefix URI prefix
+   * @param callback invoked with each URI; return false to stop
+   * @return number of URIs visited
+   */
+  size_t scan( const std::string &                              prefix,
+               const std::function< bool( const std::string & ) > &callback ) const;
+
+  const_iterator begin( ) const { return const_iterator( this, 0, 0 ); }
+  const_iterator end( ) const { return const_iterator( this, groups( ), size( ) ); }
+
+  /**
+   * @brief Get the memory held by the set
+   * @return bytes
+   */
+  size_t memory( ) const;
+
+ private:
+  std::string             keys;       ///< group keys, back to back
+  std::vector< uint32_t > keyOffsets; ///< per group (+1): offset of its key
+  std::vector< uint32_t > groupStart; ///< per group (+1): index of its first entry
+  std::vector< uint32_t > groupBlock; ///< per group (+1): index of its first block
+  std::string             data;       ///< front-coded entries
+  std::vector< uint64_t > blocks;     ///< per block: offset of its first entry in data
+
+  size_t      groups( ) const { return keyOffsets.size( ) - 1; }
+  std::string key( size_t group ) const;
+  int         keyCompare( size_t group, const std::string &key ) const;
+  size_t      findGroup( const std::string &key ) const;
+  size_t      findBlock( size_t group, const std::string &tail ) const;
+  size_t      visit( size_t                                              group,
+                     const std::string &                                 tail,
+                     const std::function< bool( const std::string & ) > &callback,
+                     bool &                                              stop ) const;
+};
+
+#endif
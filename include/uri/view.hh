@@ -0,0 +1,116 @@
+/* -*- Mode: c++ -*- */
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __URI_VIEW__
+#define __URI_VIEW__
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+/**
+ * Non-owning view of the components of a URI string
+ *
+ * Component boundaries follow RFC 3986 section 3; the spans point into the caller's buffer and
+ * hold the raw (still percent-encoded) bytes.  The view is only valid while that buffer is.
+ */
+class UriView {
+ public:
+  /**
+   * Pointer/length pair into the viewed buffer; a null data pointer marks an absent component
+   */
+  struct Span {
+    const char *data;
+    size_t      size;
+
+    Span( )
+      : data( nullptr )
+      , size( 0 ) {}
+    Span( const char *_data, size_t _size )
+      : data( _data )
+      , size( _size ) {}
+
+    bool        present( ) const { return data != nullptr; }
+    bool        empty( ) const { return size == 0; }
+    const char *begin( ) const { return data; }
+    const char *end( ) const { return data + size; }
+    std::string str( ) const {
+      return ( data == nullptr ) ? std::string( ) : std::string( data, size );
+    }
+
+    bool operator==( const std::string &other ) const {
+      return ( size == other.size( ) ) && ( ( size == 0 ) || !memcmp( data, other.data( ), size ) );
+    }
+    bool operator!=( const std::string &other ) const { return !( *this == other ); }
+  };
+
+  Span uri;       ///< whole input
+  Span scheme;    ///< scheme, without the ':'
+  Span authority; ///< authority, without the leading "//"
+  Span user;      ///< user name
+  Span password;  ///< password
+  Span host;      ///< host (IP literals keep their brackets)
+  Span port;      ///< port digits
+  Span resource;  ///< path
+  Span query;     ///< query, without the '?'
+  Span fragment;  ///< fragment, without the '#'
+
+  /**
+   * @brief Get the opacity of the URI (same meaning as Uri::opaque())
+   * @return true if the scheme is not followed by '/'
+   */
+  bool opaque( ) const {
+    return scheme.present( ) && !authority.present( ) &&
+           ( resource.empty( ) || ( resource.data[ 0 ] != '/' ) );
+  }
+
+  /**
+   * @brief Get the scheme and authority prefix ("scheme://authority")
+   * @return prefix span, empty if the URI has neither
+   */
+  Span prefix( ) const {
+    const char *end = authority.present( ) ? authority.end( )
+                      : scheme.present( ) ? scheme.end( ) + 1
+                                          : uri.data;
+    return Span( uri.data, end - uri.data );
+  }
+
+  /**
+   * @brief Split a URI string into its components
+   * @param data URI string
+   * @param size URI length
+   * @param view destination view
+   * @return true on success, false if the authority has a malformed port
+   */
+  static bool parse( const char *data, size_t size, UriView &view );
+
+  static bool parse( const std::string &uri, UriView &view ) {
+    return parse( uri.data( ), uri.size( ), view );
+  }
+
+  static bool parse( std::string &&, UriView & ) = delete; ///< the view would dangle
+};
+
+#endif
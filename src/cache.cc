@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uri/cache.hh"
+#include "uri/view.hh"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * One independently locked part of the cache
+ */
+struct UriCacheShard {
+  struct Slot {
+    std::string                  key;
+    std::shared_ptr< const Uri > uri;
+    bool                         referenced;
+  };
+
+  std::mutex                                lock;
+  std::unordered_map< std::string, size_t > index;
+  std::vector< Slot >                       slots;
+  size_t                                    capacity = 0;
+  size_t                                    hand     = 0;
+
+  /**
+   * @brief Look up an entry, marking it referenced
+   * @param key URI string
+   * @return cached URI, or null
+   */
+  std::shared_ptr< const Uri > find( const std::string &key ) {
+    std::lock_guard< std::mutex > guard( lock );
+    auto                          iterator = index.find( key );
+
+    if ( iterator == index.end( ) ) {
+      return nullptr;
+    }
+
+    Slot &slot      = slots[ iterator->second ];
+    slot.referenced = true;
+    return slot.uri;
+  }
+
+  /**
+   * @brief Insert an entry, evicting with the CLOCK hand when full
+   * @param key URI string
+   * @param uri parsed URI
+   * @param evicted incremented when an entry is dropped
+   * @return the cached URI (an entry inserted concurrently wins)
+   */
+  std::shared_ptr< const Uri > insert( const std::string &            key,
+                                       std::shared_ptr< const Uri >   uri,
+                                       std::atomic< uint64_t > &      evicted ) {
+    std::lock_guard< std::mutex > guard( lock );
+    auto                          iterator = index.find( key );
+
+    if ( iterator != index.end( ) ) {
+      return slots[ iterator->second ].uri;
+    }
+
+    if ( slots.size( ) < capacity ) {
+      index.emplace( key, slots.size( ) );
+      slots.push_back( Slot{ key, uri, false } );
+      return uri;
+    }
+
+    while ( slots[ hand ].referenced ) {
+      slots[ hand ].referenced = false;
+      hand                     = ( hand + 1 ) % slots.size( );
+    }
+
+    Slot &victim = slots[ hand ];
+
+    index.erase( victim.key );
+    index.emplace( key, hand );
+    victim.key        = key;
+    victim.uri        = uri;
+    victim.referenced = false;
+    hand              = ( hand + 1 ) % slots.size( );
+    ++evicted;
+
+    return uri;
+  }
+};
+
+/**
+ * UriCache implementation
+ */
+class UriCacheImpl {
+ public:
+  std::vector< UriCacheShard > shards;
+  std::atomic< uint64_t >      hits;
+  std::atomic< uint64_t >      misses;
+  std::atomic< uint64_t >      evictions;
+
+  UriCacheImpl( size_t capacity, size_t count )
+    : shards( count ? count : 1 )
+    , hits( 0 )
+    , misses( 0 )
+    , evictions( 0 ) {
+    for ( auto &shard : shards ) {
+      shard.capacity = ( capacity + shards.size( ) - 1 ) / shards.size( );
+      if ( shard.capacity == 0 ) {
+        shard.capacity = 1;
+      }
+      shard.index.reserve( shard.capacity );
+      shard.slots.reserve( shard.capacity );
+    }
+  }
+
+  std::shared_ptr< const Uri > get( const std::string &key ) {
+    UriCacheShard &shard = shards[ std::hash< std::string >( )( key ) % shards.size( ) ];
+    auto           uri   = shard.find( key );
+
+    if ( uri ) {
+      ++hits;
+      return uri;
+    }
+
+    ++misses;
+    return shard.insert( key, std::shared_ptr< const Uri >( Uri::parse( key ) ), evictions );
+  }
+};
+
+/**
+ * @brief Cache constructor
+ * @param capacity maximum number of entries
+ * @param shards number of independently locked shards
+ */
+UriCache::UriCache( size_t capacity, size_t shards )
+  : impl( new UriCacheImpl( capacity, shards ) ) {}
+
+UriCache::~UriCache( ) = default;
+
+/**
+ * @brief Get the parsed form of a URI, parsing and caching it on a miss
+ * @param uri URI to parse
+ * @throw runtime error on parsing or memory allocation
+ * @return shared, immutable URI object
+ */
+std::shared_ptr< const Uri > UriCache::get( const std::string &uri ) {
+  return impl->get( uri );
+}
+
+/**
+ * @brief Get the parsed form of the scheme and authority of a URI
+ * @param uri URI whose prefix to parse
+ * @throw runtime error on parsing or memory allocation
+ * @return shared, immutable URI object for the prefix
+ */
+std::shared_ptr< const Uri > UriCache::prefix( const std::string &uri ) {
+  UriView view;
+
+  UriView::parse( uri, view );
+  return impl->get( view.prefix( ).str( ) );
+}
+
+/**
+ * @brief Get the cache statistics
+ * @return counters, summed over the shards
+ */
+UriCache::Statistics UriCache::statistics( ) const {
+  Statistics statistics{ impl->hits, impl->misses, impl->evictions, 0 };
+
+  for ( auto &shard : impl->shards ) {
+    std::lock_guard< std::mutex > guard( shard.lock );
+    statistics.entries += shard.slots.size( );
+  }
+  return statistics;
+}
+
+/**
+ * @brief Drop every entry
+ */
+void UriCache::clear( ) {
+  for ( auto &shard : impl->shards ) {
+    std::lock_guard< std::mutex > guard( shard.lock );
+    shard.index.clear( );
+    shard.slots.clear( );
+    shard.hand = 0;
+  }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "charclass.hh"
+
+#include <cstring>
+
+/**
+ * RFC 3986 character classes, indexed by byte value
+ */
+const uint8_t uri_char_class[ 256 ] = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x00
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x08
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x10
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x18
+  0x00, 0x10, 0x00, 0x08, 0x10, 0x00, 0x10, 0x10, // 0x20
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x04, 0x04, 0x08, // 0x28
+  0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, // 0x30
+  0x22, 0x22, 0x08, 0x10, 0x00, 0x10, 0x00, 0x08, // 0x38
+  0x08, 0x21, 0x21, 0x21, 0x21, 0x21, 0x21, 0x01, // 0x40
+  0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, // 0x48
+  0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, // 0x50
+  0x01, 0x01, 0x01, 0x08, 0x00, 0x08, 0x00, 0x04, // 0x58
+  0x00, 0x21, 0x21, 0x21, 0x21, 0x21, 0x21, 0x01, // 0x60
+  0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, // 0x68
+  0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, // 0x70
+  0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x04, 0x00, // 0x78
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x80
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x88
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x90
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x98
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xA0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xA8
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xB0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xB8
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xC0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xC8
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xD0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xD8
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xE0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xE8
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xF0
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0xF8
+};
+
+/**
+ * @brief Get the 256-bit table of a percent-encoding set
+ * @param set encoding set
+ * @return 32 bytes; bit (ch & 7) of byte (ch >> 3) is set when ch must be escaped
+ */
+const uint8_t *uri_encode_set( Uri::EncodeSet set ) {
+  static const struct EncodeSets {
+    uint8_t bits[ Uri::ENCODE_FORM + 1 ][ 32 ];
+
+    void escape( Uri::EncodeSet set, unsigned char ch, bool value ) {
+      if ( value ) {
+        bits[ set ][ ch >> 3 ] |= static_cast< uint8_t >( 1 << ( ch & 7 ) );
+      }
+    }
+
+    EncodeSets( ) {
+      memset( bits, 0, sizeof( bits ) );
+
+      for ( int value = 0; value < 256; ++value ) {
+        unsigned char ch     = static_cast< unsigned char >( value );
+        bool          common = uri_is( ch, URI_CC_UNRESERVED | URI_CC_SUB_DELIM );
+        bool          pchar  = common || ( ch == ':' ) || ( ch == '@' );
+        bool          query  = pchar || ( ch == '/' ) || ( ch == '?' );
+
+        escape( Uri::ENCODE_DEFAULT, ch,
+                ( ch != 0 ) && ( strchr( ":/?#[]@%!$&'()*+,; =", ch ) != nullptr ) );
+        escape( Uri::ENCODE_PATH, ch, !pchar && ( ch != '/' ) );
+        escape( Uri::ENCODE_PATH_SEGMENT, ch, !pchar );
+        escape( Uri::ENCODE_QUERY, ch, !query || ( ch == '&' ) || ( ch == '+' ) );
+        escape( Uri::ENCODE_QUERY_KEY, ch,
+                !query || ( ch == '&' ) || ( ch == '+' ) || ( ch == '=' ) );
+        escape( Uri::ENCODE_FRAGMENT, ch, !query );
+        escape( Uri::ENCODE_USERINFO, ch, !common );
+        escape( Uri::ENCODE_FORM, ch,
+                !uri_is( ch, URI_CC_ALPHA | URI_CC_DIGIT ) && ( ch != '*' ) && ( ch != '-' ) &&
+                  ( ch != '.' ) && ( ch != '_' ) && ( ch != ' ' ) );
+      }
+    }
+  } sets;
+
+  return sets.bits[ set ];
+}
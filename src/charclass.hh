@@ -0,0 +1,159 @@
+/* -*- Mode: c++ -*- */
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __URI_CHARCLASS__
+#define __URI_CHARCLASS__
+
+#include "uri/uri.hh"
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Internal RFC 3986 character classification shared by the parsers, encoders and scanners.
+ * Not installed; only the library sources include this header.
+ */
+
+static constexpr uint8_t URI_CC_ALPHA     = 0x01; ///< ALPHA
+static constexpr uint8_t URI_CC_DIGIT     = 0x02; ///< DIGIT
+static constexpr uint8_t URI_CC_MARK      = 0x04; ///< "-" / "." / "_" / "~"
+static constexpr uint8_t URI_CC_GEN_DELIM = 0x08; ///< ":" / "/" / "?" / "#" / "[" / "]" / "@"
+static constexpr uint8_t URI_CC_SUB_DELIM = 0x10; ///< "!" / "$" / "&" / "'" / "(" / ")" / "*" ...
+static constexpr uint8_t URI_CC_HEXDIG    = 0x20; ///< HEXDIG
+
+static constexpr uint8_t URI_CC_UNRESERVED = URI_CC_ALPHA | URI_CC_DIGIT | URI_CC_MARK;
+static constexpr uint8_t URI_CC_RESERVED   = URI_CC_GEN_DELIM | URI_CC_SUB_DELIM;
+
+extern const uint8_t uri_char_class[ 256 ];
+
+static constexpr const char *URI_HEX_DIGITS = "0123456789ABCDEF";
+
+/**
+ * @brief Test a character against a set of character classes
+ * @param ch character to test
+ * @param mask URI_CC_* class mask
+ * @return true if the character belongs to any of the classes
+ */
+inline bool uri_is( unsigned char ch, uint8_t mask ) {
+  return ( uri_char_class[ ch ] & mask ) != 0;
+}
+
+/**
+ * @brief Convert a hexadecimal digit to its value
+ * @param ch hexadecimal digit
+ * @return digit value, 0 if not a hexadecimal digit (matches Uri::unescape)
+ */
+inline uint8_t uri_hex_value( unsigned char ch ) {
+  if ( ( ch >= 'A' ) && ( ch <= 'F' ) ) {
+    return ( ch - 'A' ) + 10;
+  } else if ( ( ch >= 'a' ) && ( ch <= 'f' ) ) {
+    return ( ch - 'a' ) + 10;
+  } else if ( ( ch >= '0' ) && ( ch <= '9' ) ) {
+    return ( ch - '0' );
+  }
+  return 0;
+}
+
+/**
+ * @brief Write a percent encoded triplet
+ * @param out output position (at least 3 bytes)
+ * @param ch character to encode
+ * @return position following the triplet
+ */
+inline char *uri_pct_encode( char *out, unsigned char ch ) {
+  out[ 0 ] = '%';
+  out[ 1 ] = URI_HEX_DIGITS[ ch >> 4 ];
+  out[ 2 ] = URI_HEX_DIGITS[ ch & 0x0F ];
+  return out + 3;
+}
+
+/**
+ * @brief Check for a complete percent encoded triplet
+ * @param data buffer start
+ * @param size bytes available from data
+ * @return true if data begins with '%' HEXDIG HEXDIG
+ */
+inline bool uri_is_pct_triplet( const char *data, size_t size ) {
+  return ( size >= 3 ) && ( data[ 0 ] == '%' ) &&
+         uri_is( static_cast< unsigned char >( data[ 1 ] ), URI_CC_HEXDIG ) &&
+         uri_is( static_cast< unsigned char >( data[ 2 ] ), URI_CC_HEXDIG );
+}
+
+/**
+ * @brief Get the 256-bit table of a percent-encoding set
+ * @param set encoding set
+ * @return 32 bytes; bit (ch & 7) of byte (ch >> 3) is set when ch must be escaped
+ */
+const uint8_t *uri_encode_set( Uri::EncodeSet set );
+
+/**
+ * @brief Test a character against a percent-encoding set
+ * @param table uri_encode_set() table
+ * @param ch character to test
+ * @return true if the character must be escaped
+ */
+inline bool uri_must_encode( const uint8_t *table, unsigned char ch ) {
+  return ( ( table[ ch >> 3 ] >> ( ch & 7 ) ) & 1 ) != 0;
+}
+
+/**
+ * @brief Count the bytes a value occupies once escaped
+ * @param table uri_encode_set() table
+ * @param data raw value
+ * @param size raw value length
+ * @return escaped length
+ */
+inline size_t uri_encoded_size( const uint8_t *table, const char *data, size_t size ) {
+  size_t length = size;
+
+  for ( size_t index = 0; index < size; ++index ) {
+    length += uri_must_encode( table, static_cast< unsigned char >( data[ index ] ) ) ? 2 : 0;
+  }
+  return length;
+}
+
+/**
+ * @brief Escape a value
+ * @note A space left unescaped by the set (only ENCODE_FORM) is written as '+'
+ * @param out output position (at least uri_encoded_size() bytes)
+ * @param table uri_encode_set() table
+ * @param data raw value
+ * @param size raw value length
+ * @return position following the output
+ */
+inline char *uri_encode( char *out, const uint8_t *table, const char *data, size_t size ) {
+  for ( size_t index = 0; index < size; ++index ) {
+    unsigned char ch = static_cast< unsigned char >( data[ index ] );
+
+    if ( uri_must_encode( table, ch ) ) {
+      out = uri_pct_encode( out, ch );
+    } else {
+      *out++ = ( ch == ' ' ) ? '+' : static_cast< char >( ch );
+    }
+  }
+  return out;
+}
+
+#endif
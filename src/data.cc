@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uri/data.hh"
+#include "charclass.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <strings.h>
+
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && defined( __GNUC__ )
+#define DATA_BASE64_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+static const char DEFAULT_TYPE[] = "text/plain";
+
+static constexpr uint8_t B64_INVALID = 0xFF;
+static constexpr uint8_t B64_SKIP    = 0xFE; ///< ASCII whitespace
+static constexpr uint8_t B64_PAD     = 0xFD; ///< '='
+
+/**
+ * @brief Build the base64 decoding table
+ * @return table of 6 bit values / B64_* markers, indexed by byte value
+ */
+static const uint8_t *base64_table( ) {
+  static const struct Table {
+    uint8_t value[ 256 ];
+
+    Table( ) {
+      static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+      memset( value, B64_INVALID, sizeof( value ) );
+      for ( uint8_t index = 0; index < 64; ++index ) {
+        value[ static_cast< unsigned char >( alphabet[ index ] ) ] = index;
+      }
+      value[ static_cast< unsigned char >( ' ' ) ]  = B64_SKIP;
+      value[ static_cast< unsigned char >( '\t' ) ] = B64_SKIP;
+      value[ static_cast< unsigned char >( '\r' ) ] = B64_SKIP;
+      value[ static_cast< unsigned char >( '\n' ) ] = B64_SKIP;
+      value[ static_cast< unsigned char >( '=' ) ]  = B64_PAD;
+    }
+  } table;
+
+  return table.value;
+}
+
+#if defined( DATA_BASE64_SSSE3 )
+/**
+ * @brief Check once whether the CPU can run base64_block()
+ * @return true if SSSE3 is available
+ */
+static bool base64_ssse3( ) {
+  static const bool supported = ( __builtin_cpu_init( ), __builtin_cpu_supports( "ssse3" ) != 0 );
+  return supported;
+}
+
+/**
+ * @brief Decode 16 base64 characters into 12 bytes
+ *
+ * Classification and translation use nibble lookups (W. Muła, D. Lemire, "Faster Base64
+ * Encoding and Decoding Using AVX2 Instructions").  Compiled for SSSE3 whatever the build's
+ * target; callers check base64_ssse3() first.
+ *
+ * @param in 16 input characters
+ * @param out output position (12 bytes are written)
+ * @return false if any of the characters is not in the base64 alphabet
+ */
+__attribute__( ( target( "ssse3" ) ) ) static bool base64_block( const char *in, char *out ) {
+  const __m128i lut_lo   = _mm_setr_epi8( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                        0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A );
+  const __m128i lut_hi   = _mm_setr_epi8( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10,
+                                        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+  const __m128i lut_roll = _mm_setr_epi8( 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0,
+                                          0 );
+  const __m128i mask_2f  = _mm_set1_epi8( 0x2F );
+
+  __m128i input = _mm_loadu_si128( reinterpret_cast< const __m128i * >( in ) );
+  __m128i hi    = _mm_and_si128( _mm_srli_epi32( input, 4 ), mask_2f );
+  __m128i lo    = _mm_and_si128( input, mask_2f );
+  __m128i check = _mm_and_si128( _mm_shuffle_epi8( lut_lo, lo ), _mm_shuffle_epi8( lut_hi, hi ) );
+
+  if ( _mm_movemask_epi8( _mm_cmpeq_epi8( check, _mm_setzero_si128( ) ) ) != 0xFFFF ) {
+    return false;
+  }
+
+  __m128i roll   = _mm_shuffle_epi8( lut_roll,
+                                   _mm_add_epi8( _mm_cmpeq_epi8( input, mask_2f ), hi ) );
+  __m128i values = _mm_add_epi8( input, roll );
+  __m128i merged = _mm_maddubs_epi16( values, _mm_set1_epi32( 0x01400140 ) );
+  __m128i packed = _mm_madd_epi16( merged, _mm_set1_epi32( 0x00011000 ) );
+
+  packed = _mm_shuffle_epi8(
+    packed, _mm_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) );
+
+  char bytes[ 16 ];
+  _mm_storeu_si128( reinterpret_cast< __m128i * >( bytes ), packed );
+  memcpy( out, bytes, 12 );
+  return true;
+}
+#endif
+
+/**
+ * @brief Decode base64 text
+ * @param data base64 text
+ * @param size text length
+ * @param out output buffer of at least ( size + 3 ) / 4 * 3 bytes
+ * @return decoded length, or INVALID on malformed input
+ */
+size_t DataUri::decodeBase64( const char *data, size_t size, char *out ) {
+  const uint8_t *table = base64_table( );
+  const char *   pos   = data;
+  const char *   end   = data + size;
+  char *         start = out;
+  uint32_t       bits  = 0;
+  int            count = 0;
+#if defined( DATA_BASE64_SSSE3 )
+  bool           simd  = base64_ssse3( );
+#endif
+
+  while ( pos != end ) {
+    if ( count == 0 ) {
+#if defined( DATA_BASE64_SSSE3 )
+      while ( simd && ( end - pos >= 16 ) && base64_block( pos, out ) ) {
+        pos += 16;
+        out += 12;
+      }
+#endif
+      /* Whole quantum of four plain characters */
+      while ( end - pos >= 4 ) {
+        uint8_t a = table[ static_cast< unsigned char >( pos[ 0 ] ) ];
+        uint8_t b = table[ static_cast< unsigned char >( pos[ 1 ] ) ];
+        uint8_t c = table[ static_cast< unsigned char >( pos[ 2 ] ) ];
+        uint8_t d = table[ static_cast< unsigned char >( pos[ 3 ] ) ];
+
+        if ( ( a | b | c | d ) & 0xC0 ) {
+          break;
+        }
+
+        uint32_t quantum = ( a << 18 ) | ( b << 12 ) | ( c << 6 ) | d;
+        out[ 0 ]         = static_cast< char >( quantum >> 16 );
+        out[ 1 ]         = static_cast< char >( quantum >> 8 );
+        out[ 2 ]         = static_cast< char >( quantum );
+        out += 3;
+        pos += 4;
+      }
+
+      if ( pos == end ) {
+        break;
+      }
+    }
+
+    uint8_t value = table[ static_cast< unsigned char >( *pos++ ) ];
+
+    if ( value == B64_SKIP ) {
+      continue;
+    } else if ( value == B64_PAD ) {
+      /* Only padding and whitespace may follow */
+      for ( ; pos != end; ++pos ) {
+        uint8_t trailing = table[ static_cast< unsigned char >( *pos ) ];
+        if ( ( trailing != B64_PAD ) && ( trailing != B64_SKIP ) ) {
+          return INVALID;
+        }
+      }
+      break;
+    } else if ( value == B64_INVALID ) {
+      return INVALID;
+    }
+
+    bits = ( bits << 6 ) | value;
+    if ( ++count == 4 ) {
+      out[ 0 ] = static_cast< char >( bits >> 16 );
+      out[ 1 ] = static_cast< char >( bits >> 8 );
+      out[ 2 ] = static_cast< char >( bits );
+      out += 3;
+      bits  = 0;
+      count = 0;
+    }
+  }
+
+  /* Partial final quantum: 2 characters carry 1 byte, 3 carry 2 */
+  if ( count == 1 ) {
+    return INVALID;
+  } else if ( count == 2 ) {
+    *out++ = static_cast< char >( bits >> 4 );
+  } else if ( count == 3 ) {
+    *out++ = static_cast< char >( bits >> 10 );
+    *out++ = static_cast< char >( bits >> 2 );
+  }
+
+  return out - start;
+}
+
+/**
+ * @brief Split a "data:" URI
+ *
+ * dataurl := "data:" [ mediatype ] [ ";base64" ] "," data
+ *
+ * @param data URI string
+ * @param size URI length
+ * @param uri destination
+ * @return true on success, false if the input is not a data URI
+ */
+bool DataUri::parse( const char *data, size_t size, DataUri &uri ) {
+  const char *end = data + size;
+
+  uri = DataUri( );
+
+  if ( ( size < 5 ) || strncasecmp( data, "data:", 5 ) ) {
+    return false;
+  }
+
+  const char *header = data + 5;
+  const char *comma  = static_cast< const char * >( memchr( header, ',', end - header ) );
+
+  if ( comma == nullptr ) {
+    return false;
+  }
+
+  const char *fragment = static_cast< const char * >( memchr( comma, '#', end - comma ) );
+  const char *pos      = header;
+
+  uri.body = Span( comma + 1, ( ( fragment != nullptr ) ? fragment : end ) - comma - 1 );
+
+  while ( pos <= comma ) {
+    const char *next = static_cast< const char * >( memchr( pos, ';', comma - pos ) );
+
+    if ( next == nullptr ) {
+      next = comma;
+    }
+
+    if ( pos == header ) {
+      uri.type = Span( pos, next - pos );
+    } else if ( ( next - pos == 6 ) && !strncasecmp( pos, "base64", 6 ) && ( next == comma ) ) {
+      uri.isBase64 = true;
+    } else if ( next != pos ) {
+      const char *equals = static_cast< const char * >( memchr( pos, '=', next - pos ) );
+
+      if ( equals == nullptr ) {
+        uri.params.emplace_back( Span( pos, next - pos ), Span( next, 0 ) );
+      } else {
+        uri.params.emplace_back( Span( pos, equals - pos ), Span( equals + 1, next - equals - 1 ) );
+      }
+    }
+
+    pos = next + 1;
+  }
+
+  if ( uri.type.empty( ) ) {
+    uri.type = Span( DEFAULT_TYPE, sizeof( DEFAULT_TYPE ) - 1 );
+  }
+
+  return true;
+}
+
+/**
+ * @brief Look up a media type parameter
+ * @param name parameter name (case-insensitive)
+ * @return parameter value, absent if the parameter is not given
+ */
+DataUri::Span DataUri::parameter( const std::string &name ) const {
+  for ( auto &param : params ) {
+    if ( ( param.first.size == name.size( ) ) &&
+         !strncasecmp( param.first.data, name.data( ), name.size( ) ) ) {
+      return param.second;
+    }
+  }
+  return Span( );
+}
+
+/**
+ * @brief Decode the payload
+ * @param out output buffer
+ * @param capacity output buffer size
+ * @return decoded length, or INVALID on malformed base64 or insufficient capacity
+ */
+size_t DataUri::decode( char *out, size_t capacity ) const {
+  if ( capacity < decodedSize( ) ) {
+    return INVALID;
+  }
+
+  if ( isBase64 ) {
+    return decodeBase64( body.data, body.size, out );
+  }
+
+  const char *pos   = body.begin( );
+  const char *end   = body.end( );
+  char *      start = out;
+
+  while ( pos != end ) {
+    const char *escape = static_cast< const char * >( memchr( pos, '%', end - pos ) );
+    const char *run    = ( escape != nullptr ) ? escape : end;
+
+    memcpy( out, pos, run - pos );
+    out += run - pos;
+    pos = run;
+
+    if ( pos != end ) {
+      if ( end - pos >= 3 ) {
+        *out++ = static_cast< char >( ( uri_hex_value( pos[ 1 ] ) << 4 ) |
+                                      uri_hex_value( pos[ 2 ] ) );
+      }
+      pos += std::min< ptrdiff_t >( 3, end - pos );
+    }
+  }
+
+  return out - start;
+}
+
+/**
+ * @brief Decode the payload into a string
+ * @throw runtime error on malformed base64
+ * @return decoded payload
+ */
+std::string DataUri::decode( ) const {
+  std::string out( decodedSize( ), '\0' );
+  size_t      size = out.empty( ) ? 0 : decode( &out[ 0 ], out.size( ) );
+
+  if ( size == INVALID ) {
+    throw std::runtime_error( "data URI payload is not valid base64" );
+  }
+
+  out.resize( size );
+  return out;
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uri/extract.hh"
+#include "charclass.hh"
+
+#include <cctype>
+#include <cstring>
+#include <strings.h>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+static constexpr size_t SCHEME_MAX = 32;
+
+/**
+ * Schemes recognised without a following "//"
+ */
+static const char *const OPAQUE_SCHEMES[] = { "mailto", "tel", "urn", "data", "news", "sip",
+                                              "sips", "xmpp", "magnet", "sms" };
+
+/**
+ * @brief Find the next anchor character (':' or 'w'/'W')
+ * @param pos scan position
+ * @param end end of text
+ * @return anchor position, or end
+ */
+static const char *extract_anchor( const char *pos, const char *end ) {
+#if defined( __SSE2__ )
+  const __m128i colon = _mm_set1_epi8( ':' );
+  const __m128i w     = _mm_set1_epi8( 'w' );
+  const __m128i lower = _mm_set1_epi8( 0x20 );
+
+  while ( end - pos >= 16 ) {
+    __m128i chunk = _mm_loadu_si128( reinterpret_cast< const __m128i * >( pos ) );
+    int     mask  = _mm_movemask_epi8( _mm_or_si128(
+      _mm_cmpeq_epi8( chunk, colon ), _mm_cmpeq_epi8( _mm_or_si128( chunk, lower ), w ) ) );
+
+    if ( mask != 0 ) {
+      return pos + __builtin_ctz( mask );
+    }
+    pos += 16;
+  }
+#endif
+
+  for ( ; pos != end; ++pos ) {
+    if ( ( *pos == ':' ) || ( ( *pos | 0x20 ) == 'w' ) ) {
+      return pos;
+    }
+  }
+  return end;
+}
+
+/**
+ * @brief Extend a candidate over URI characters
+ *
+ * Brackets must balance: a closing bracket with no opener ends the URI.  Trailing
+ * punctuation that is more likely sentence than URI is dropped.
+ *
+ * @param body first character after the anchor
+ * @param end end of text
+ * @return end of the URI
+ */
+static const char *extract_extend( const char *body, const char *end ) {
+  const char *pos      = body;
+  int         parens   = 0;
+  int         brackets = 0;
+
+  for ( ; pos != end; ++pos ) {
+    unsigned char ch = static_cast< unsigned char >( *pos );
+
+    if ( ch == '(' ) {
+      ++parens;
+    } else if ( ch == ')' ) {
+      if ( parens-- == 0 ) {
+        break;
+      }
+    } else if ( ch == '[' ) {
+      ++brackets;
+    } else if ( ch == ']' ) {
+      if ( brackets-- == 0 ) {
+        break;
+      }
+    } else if ( !uri_is( ch, URI_CC_UNRESERVED | URI_CC_RESERVED ) && ( ch != '%' ) ) {
+      break;
+    }
+  }
+
+  while ( ( pos != body ) && ( strchr( ".,;:!?'*", pos[ -1 ] ) != nullptr ) ) {
+    --pos;
+  }
+  return pos;
+}
+
+/**
+ * @brief Check an anchor for a "scheme:" candidate
+ * @param floor earliest position the scheme may start at
+ * @param colon anchor position
+ * @param end end of text
+ * @return candidate start, or nullptr if the anchor does not start a URI
+ */
+static const char *extract_scheme( const char *floor, const char *colon, const char *end ) {
+  const char *start = colon;
+
+  while ( ( start != floor ) && ( static_cast< size_t >( colon - start ) <= SCHEME_MAX ) &&
+          ( uri_is( static_cast< unsigned char >( start[ -1 ] ), URI_CC_ALPHA | URI_CC_DIGIT ) ||
+            ( start[ -1 ] == '+' ) || ( start[ -1 ] == '-' ) || ( start[ -1 ] == '.' ) ) ) {
+    --start;
+  }
+
+  while ( ( start != colon ) && !uri_is( static_cast< unsigned char >( *start ), URI_CC_ALPHA ) ) {
+    ++start;
+  }
+
+  if ( ( start == colon ) || ( static_cast< size_t >( colon - start ) > SCHEME_MAX ) ) {
+    return nullptr;
+  }
+
+  if ( ( end - colon > 3 ) && ( colon[ 1 ] == '/' ) && ( colon[ 2 ] == '/' ) ) {
+    return start;
+  }
+
+  for ( auto scheme : OPAQUE_SCHEMES ) {
+    size_t length = strlen( scheme );
+
+    if ( ( length == static_cast< size_t >( colon - start ) ) &&
+         !strncasecmp( start, scheme, length ) ) {
+      return start;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Scan text for URIs
+ * @param data text
+ * @param size text length
+ * @param callback invoked for every URI, in order of appearance
+ * @return number of URIs reported
+ */
+size_t UriExtractor::extract( const char *data, size_t size, const Callback &callback ) {
+  const char *end   = data + size;
+  const char *pos   = data;
+  const char *floor = data;
+  size_t      count = 0;
+
+  while ( ( pos = extract_anchor( pos, end ) ) != end ) {
+    const char *start = nullptr;
+    const char *body  = nullptr;
+    bool        www   = false;
+
+    if ( *pos == ':' ) {
+      start = extract_scheme( floor, pos, end );
+      body  = pos + 1;
+    } else if ( ( end - pos > 4 ) && !strncasecmp( pos, "www.", 4 ) &&
+                ( ( pos == data ) ||
+                  !uri_is( static_cast< unsigned char >( pos[ -1 ] ), URI_CC_UNRESERVED ) ) &&
+                uri_is( static_cast< unsigned char >( pos[ 4 ] ), URI_CC_ALPHA | URI_CC_DIGIT ) ) {
+      start = pos;
+      body  = pos + 4;
+      www   = true;
+    }
+
+    if ( start == nullptr ) {
+      ++pos;
+      continue;
+    }
+
+    const char *stop = extract_extend( body, end );
+
+    if ( stop <= body + ( ( !www && ( body[ 0 ] == '/' ) ) ? 2 : 0 ) ) {
+      pos = body;
+      continue;
+    }
+
+    Match match;
+
+    match.offset = start - data;
+    match.length = stop - start;
+    match.www    = www;
+    UriView::parse( start, stop - start, match.view );
+
+    ++count;
+    if ( !callback( match ) ) {
+      break;
+    }
+    pos   = stop;
+    floor = stop;
+  }
+
+  return count;
+}
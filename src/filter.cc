@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uri/filter.hh"
+#include "charclass.hh"
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr uint32_t NO_NODE = 0;
+
+QueryFilter::QueryFilter( )
+  : nodes( 1, Node{ { }, 0 } ) {}
+
+/**
+ * @brief Find a child node
+ * @param node parent node
+ * @param ch edge character
+ * @return child node, or NO_NODE (the root is never a child)
+ */
+uint32_t QueryFilter::child( uint32_t node, unsigned char ch ) const {
+  auto &children = nodes[ node ].children;
+  auto  iterator = std::lower_bound(
+    children.begin( ), children.end( ), ch,
+    []( const std::pair< unsigned char, uint32_t > &edge, unsigned char key ) {
+      return edge.first < key;
+    } );
+
+  return ( ( iterator != children.end( ) ) && ( iterator->first == ch ) ) ? iterator->second
+                                                                            : NO_NODE;
+}
+
+/**
+ * @brief Add a name to the trie
+ * @param name decoded field name
+ * @param flag EXACT or PREFIX
+ */
+void QueryFilter::insert( const std::string &name, uint8_t flag ) {
+  uint32_t node = 0;
+
+  for ( unsigned char ch : name ) {
+    uint32_t next = child( node, ch );
+
+    if ( next == NO_NODE ) {
+      auto &children = nodes[ node ].children;
+      auto  position = std::lower_bound(
+        children.begin( ), children.end( ), std::make_pair( ch, uint32_t( 0 ) ) );
+
+      next = static_cast< uint32_t >( nodes.size( ) );
+      children.insert( position, std::make_pair( ch, next ) );
+      nodes.push_back( Node{ { }, 0 } );
+    }
+    node = next;
+  }
+
+  nodes[ node ].flags |= flag;
+}
+
+QueryFilter &QueryFilter::key( const std::string &name ) {
+  insert( name, EXACT );
+  return *this;
+}
+
+QueryFilter &QueryFilter::prefix( const std::string &name ) {
+  insert( name, PREFIX );
+  return *this;
+}
+
+/**
+ * @brief Walk the trie with a decoded name
+ * @param name decoded field name
+ * @param size name length
+ * @return true if the name is stripped
+ */
+bool QueryFilter::lookup( const char *name, size_t size ) const {
+  uint32_t node = 0;
+
+  for ( size_t index = 0; index < size; ++index ) {
+    if ( nodes[ node ].flags & PREFIX ) {
+      return true;
+    }
+
+    node = child( node, static_cast< unsigned char >( name[ index ] ) );
+    if ( node == NO_NODE ) {
+      return false;
+    }
+  }
+
+  return nodes[ node ].flags != 0;
+}
+
+/**
+ * @brief Check a raw field name against the filter
+ * @param name field name
+ * @param size name length
+ * @return true if the field is stripped
+ */
+bool QueryFilter::matches( const char *name, size_t size ) const {
+  if ( ( memchr( name, '%', size ) == nullptr ) && ( memchr( name, '+', size ) == nullptr ) ) {
+    return lookup( name, size );
+  }
+
+  std::string decoded;
+
+  decoded.reserve( size );
+  for ( size_t index = 0; index < size; ++index ) {
+    if ( ( name[ index ] == '%' ) && ( index + 2 < size ) ) {
+      decoded.push_back( static_cast< char >( ( uri_hex_value( name[ index + 1 ] ) << 4 ) |
+                                              uri_hex_value( name[ index + 2 ] ) ) );
+      index += 2;
+    } else if ( name[ index ] == '+' ) {
+      decoded.push_back( ' ' );
+    } else {
+      decoded.push_back( name[ index ] );
+    }
+  }
+
+  return lookup( decoded.data( ), decoded.size( ) );
+}
+
+/**
+ * @brief Filter the query of a URI into an output buffer
+ *
+ * Only stripped pairs are dropped, each with one separator; the '?' is dropped with the last
+ * pair.  Without a stripped pair the output is identical to the input.
+ *
+ * @param data URI string
+ * @param size URI length
+ * @param out output buffer of at least @p size bytes; may be @p data
+ * @return length of the filtered URI
+ */
+size_t QueryFilter::apply( const char *data, size_t size, char *out ) const {
+  const char *end      = data + size;
+  const char *fragment = static_cast< const char * >( memchr( data, '#', size ) );
+  const char *query    = static_cast< const char * >(
+    memchr( data, '?', ( ( fragment != nullptr ) ? fragment : end ) - data ) );
+  char *      pos      = out;
+
+  if ( fragment == nullptr ) {
+    fragment = end;
+  }
+
+  if ( query == nullptr ) {
+    if ( out != data ) {
+      memcpy( out, data, size );
+    }
+    return size;
+  }
+
+  if ( out != data ) {
+    memmove( pos, data, query - data );
+  }
+  pos += query - data;
+
+  char separator = '?';
+
+  for ( const char *field = query + 1; field <= fragment; ) {
+    const char *next = static_cast< const char * >( memchr( field, '&', fragment - field ) );
+
+    if ( next == nullptr ) {
+      next = fragment;
+    }
+
+    const char *equals = static_cast< const char * >( memchr( field, '=', next - field ) );
+    const char *name   = ( equals != nullptr ) ? equals : next;
+
+    if ( !matches( field, name - field ) ) {
+      *pos++ = separator;
+      memmove( pos, field, next - field );
+      pos += next - field;
+      separator = '&';
+    }
+
+    field = next + 1;
+  }
+
+  memmove( pos, fragment, end - fragment );
+  pos += end - fragment;
+
+  return pos - out;
+}
+
+/**
+ * @brief Filter the query of a URI in place
+ *
+ * Every stripped pair removes at least its separator, so the URI shrinks exactly when a field
+ * was stripped.
+ *
+ * @param uri URI string
+ * @return true if any field was stripped
+ */
+bool QueryFilter::apply( std::string &uri ) const {
+  if ( uri.empty( ) ) {
+    return false;
+  }
+
+  size_t size     = apply( uri.data( ), uri.size( ), &uri[ 0 ] );
+  bool   stripped = ( size != uri.size( ) );
+
+  uri.resize( size );
+  return stripped;
+}
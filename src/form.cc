@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uri/form.hh"
+#include "charclass.hh"
+
+/**
+ * @brief Decoder constructor
+ * @param callback receives each decoded name/value pair
+ * @param limit maximum decoded length of a single name or value, 0 for no limit
+ * @param plus decode '+' as a space
+ */
+FormDecoder::FormDecoder( Callback callback, size_t limit, bool plus )
+  : callback( std::move( callback ) )
+  , limit( limit )
+  , plus( plus ) {
+  reset( );
+}
+
+/**
+ * @brief Reset the decoder for a new body
+ */
+void FormDecoder::reset( ) {
+  failed  = false;
+  inValue = false;
+  pending = 0;
+  octet   = 0;
+  key.clear( );
+  value.clear( );
+}
+
+/**
+ * @brief Append decoded bytes to the current field
+ * @param data decoded bytes
+ * @param size byte count
+ * @return false if the field limit was exceeded
+ */
+bool FormDecoder::append( const char *data, size_t size ) {
+  std::string &field = inValue ? value : key;
+
+  if ( ( limit != 0 ) && ( field.size( ) + size > limit ) ) {
+    return false;
+  }
+  field.append( data, size );
+  return true;
+}
+
+/**
+ * @brief Emit the current pair (empty pairs are skipped)
+ * @return false if the callback stopped decoding
+ */
+bool FormDecoder::pair( ) {
+  bool result = true;
+
+  if ( inValue || !key.empty( ) ) {
+    result = callback( key, value );
+  }
+
+  inValue = false;
+  key.clear( );
+  value.clear( );
+  return result;
+}
+
+/**
+ * @brief Decode the next chunk of the body
+ * @param data chunk
+ * @param size chunk length
+ * @return true on success, false if a field exceeded the limit or the callback stopped
+ */
+bool FormDecoder::feed( const char *data, size_t size ) {
+  const char *pos = data;
+  const char *end = data + size;
+
+  while ( !failed && ( pos != end ) ) {
+    if ( pending != 0 ) {
+      octet = static_cast< uint8_t >( ( octet << 4 ) | uri_hex_value( *pos++ ) );
+
+      if ( --pending == 0 ) {
+        char ch = static_cast< char >( octet );
+        failed  = !append( &ch, 1 );
+      }
+      continue;
+    }
+
+    const char *run = pos;
+
+    while ( ( pos != end ) && ( *pos != '%' ) && ( *pos != '&' ) && ( *pos != '=' ) &&
+            ( !plus || ( *pos != '+' ) ) ) {
+      ++pos;
+    }
+
+    if ( ( pos != run ) && !append( run, pos - run ) ) {
+      failed = true;
+      break;
+    }
+
+    if ( pos == end ) {
+      break;
+    }
+
+    switch ( *pos++ ) {
+      case '%':
+        pending = 2;
+        octet   = 0;
+        break;
+      case '+': failed = !append( " ", 1 ); break;
+      case '&': failed = !pair( ); break;
+      case '=':
+        if ( inValue ) {
+          failed = !append( "=", 1 );
+        } else {
+          inValue = true;
+        }
+        break;
+    }
+  }
+
+  return !failed;
+}
+
+/**
+ * @brief Signal the end of the body, flushing the last pair
+ * @note A percent escape cut short by the end of the body is dropped, as Uri::unescape does
+ * @return true on success, false on failure
+ */
+bool FormDecoder::finish( ) {
+  if ( !failed ) {
+    pending = 0;
+    failed  = !pair( );
+  }
+  return !failed;
+}
+
+/**
+ * @brief Encoder constructor
+ * @param sink receives encoded output
+ * @param capacity buffer size before output is handed to the sink
+ */
+FormEncoder::FormEncoder( Sink sink, size_t capacity )
+  : sink( std::move( sink ) )
+  , capacity( capacity )
+  , first( true ) {
+  buffer.reserve( capacity );
+}
+
+FormEncoder::~FormEncoder( ) {
+  flush( );
+}
+
+/**
+ * @brief Escape a value into the buffer
+ * @param value raw value
+ */
+void FormEncoder::encode( const std::string &value ) {
+  const uint8_t *table  = uri_encode_set( Uri::ENCODE_FORM );
+  size_t         offset = buffer.size( );
+
+  buffer.resize( offset + uri_encoded_size( table, value.data( ), value.size( ) ) );
+  uri_encode( &buffer[ offset ], table, value.data( ), value.size( ) );
+}
+
+/**
+ * @brief Encode a name/value pair
+ * @param key field name
+ * @param value field value
+ */
+void FormEncoder::add( const std::string &key, const std::string &value ) {
+  if ( !first ) {
+    buffer.push_back( '&' );
+  }
+  first = false;
+
+  encode( key );
+  buffer.push_back( '=' );
+  encode( value );
+
+  if ( buffer.size( ) >= capacity ) {
+    flush( );
+  }
+}
+
+/**
+ * @brief Hand any buffered output to the sink
+ */
+void FormEncoder::flush( ) {
+  if ( !buffer.empty( ) ) {
+    sink( buffer.data( ), buffer.size( ) );
+    buffer.clear( );
+  }
+}
@@ -0,0 +1,675 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uri/pattern.hh"
+#include "charclass.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+static constexpr uint16_t GLOB_STAR        = 256;     ///< '*': any run of characters
+static constexpr size_t   GLOB_CACHE_BYTES = 1 << 20; ///< DFA cache budget before it is flushed
+static constexpr size_t   GLOB_CACHES      = 16;      ///< DFA caches kept per thread
+
+/**
+ * Unique identifier of every compiled program revision, so thread caches never outlive them
+ */
+static std::atomic< uint64_t > glob_serial( 0 );
+
+/**
+ * @brief Parse a glob into literal bytes and stars
+ * @param glob glob pattern ('*' wildcard, '\' escape)
+ * @param fold lower case the literals
+ * @return tokens (bytes, or GLOB_STAR; runs of stars are merged)
+ */
+static std::vector< uint16_t > glob_parse( const std::string &glob, bool fold ) {
+  std::vector< uint16_t > tokens;
+
+  for ( size_t pos = 0; pos < glob.size( ); ++pos ) {
+    unsigned char ch = static_cast< unsigned char >( glob[ pos ] );
+
+    if ( ch == '*' ) {
+      if ( tokens.empty( ) || ( tokens.back( ) != GLOB_STAR ) ) {
+        tokens.push_back( GLOB_STAR );
+      }
+      continue;
+    }
+
+    if ( ( ch == '\\' ) && ( pos + 1 < glob.size( ) ) ) {
+      ch = static_cast< unsigned char >( glob[ ++pos ] );
+    }
+    tokens.push_back( fold ? static_cast< uint16_t >( tolower( ch ) ) : ch );
+  }
+  return tokens;
+}
+
+/**
+ * Host suffix globs ("*." followed by literal labels) in a trie keyed by reversed labels
+ *
+ * Matching walks the host's labels right to left, so the cost depends on the host and not on
+ * the number of suffixes.
+ */
+struct LabelTrie {
+  std::unordered_map< std::string, uint32_t > edges;  ///< parent node (4 bytes) + label -> node
+  std::vector< int32_t >                      suffix; ///< per node: glob ending there, or -1
+
+  LabelTrie( )
+    : suffix( 1, -1 ) {}
+
+  /**
+   * @brief Build an edge key
+   * @param node parent node
+   * @param label label bytes
+   * @param size label length
+   * @return key
+   */
+  static std::string key( uint32_t node, const char *label, size_t size ) {
+    std::string value( reinterpret_cast< const char * >( &node ), sizeof( node ) );
+    value.append( label, size );
+    return value;
+  }
+
+  /**
+   * @brief Add a suffix glob
+   * @param domain labels following "*."
+   * @param glob glob index to use if the suffix is new
+   * @return glob index of the suffix
+   */
+  uint32_t add( const std::string &domain, uint32_t glob ) {
+    uint32_t node = 0;
+    size_t   end  = domain.size( );
+
+    for ( ;; ) {
+      size_t start = end;
+      while ( ( start > 0 ) && ( domain[ start - 1 ] != '.' ) ) {
+        --start;
+      }
+
+      auto inserted = edges.emplace( key( node, domain.data( ) + start, end - start ),
+                                     static_cast< uint32_t >( suffix.size( ) ) );
+      if ( inserted.second ) {
+        suffix.push_back( -1 );
+      }
+      node = inserted.first->second;
+
+      if ( start == 0 ) {
+        break;
+      }
+      end = start - 1;
+    }
+
+    if ( suffix[ node ] < 0 ) {
+      suffix[ node ] = static_cast< int32_t >( glob );
+    }
+    return static_cast< uint32_t >( suffix[ node ] );
+  }
+
+  /**
+   * @brief Find the suffix globs matching a host
+   * @param data host bytes (already case folded)
+   * @param size host length
+   * @param globs receives the matching glob indices
+   */
+  void match( const char *data, size_t size, std::vector< uint32_t > &globs ) const {
+    uint32_t node = 0;
+    size_t   end  = size;
+
+    for ( ;; ) {
+      size_t start = end;
+      while ( ( start > 0 ) && ( data[ start - 1 ] != '.' ) ) {
+        --start;
+      }
+
+      auto edge = edges.find( key( node, data + start, end - start ) );
+      if ( ( edge == edges.end( ) ) || ( start == 0 ) ) {
+        break; // "*." needs a dot left of the suffix
+      }
+      node = edge->second;
+      if ( suffix[ node ] >= 0 ) {
+        globs.push_back( static_cast< uint32_t >( suffix[ node ] ) );
+      }
+      end = start - 1;
+    }
+  }
+};
+
+/**
+ * Compiled globs of one URI component
+ *
+ * Literal globs are looked up in a hash map and host suffix globs in a LabelTrie.  Every other
+ * glob is a path through a prefix trie of literal and star nodes, so globs sharing a prefix
+ * (including a leading star) share NFA states.  An NFA state is a trie node: its prefix has
+ * been matched.  The program is never modified by matching; the NFA is determinized lazily into
+ * per-thread GlobCache objects.
+ */
+struct GlobProgram {
+  typedef std::vector< std::pair< uint16_t, uint32_t > > Children;
+
+  bool                                        fold   = false;
+  uint64_t                                    serial = 0;
+  std::vector< uint16_t >                     token{ 0 };    ///< per node: literal or GLOB_STAR
+  std::vector< Children >                     children = std::vector< Children >( 1 ); ///< per node
+  std::vector< int32_t >                      accept{ -1 };  ///< per node: glob ending there
+  uint16_t                                    classes[ 256 ] = { }; ///< byte -> DFA column
+  uint16_t                                    width          = 1;   ///< DFA columns
+  std::vector< std::vector< size_t > >        owners; ///< per glob: patterns it leads
+  std::unordered_map< std::string, uint32_t > exact;
+  LabelTrie                                   suffixes;
+
+  /**
+   * @brief Find a child node
+   * @param node trie node
+   * @param value token
+   * @return child node, or 0 if none
+   */
+  uint32_t child( uint32_t node, uint16_t value ) const {
+    const Children &list = children[ node ];
+    auto            found =
+      std::lower_bound( list.begin( ), list.end( ), std::make_pair( value, uint32_t( 0 ) ) );
+
+    return ( ( found != list.end( ) ) && ( found->first == value ) ) ? found->second : 0;
+  }
+
+  /**
+   * @brief Add a glob to the program
+   * @param glob glob pattern ('*' wildcard, '\' escape)
+   * @return glob index (shared by identical globs)
+   */
+  uint32_t add( const std::string &glob ) {
+    std::vector< uint16_t > tokens = glob_parse( glob, fold );
+    uint32_t                index  = static_cast< uint32_t >( owners.size( ) );
+    auto                    stars  = std::count( tokens.begin( ), tokens.end( ), GLOB_STAR );
+
+    if ( stars == 0 ) {
+      index = exact.emplace( std::string( tokens.begin( ), tokens.end( ) ), index ).first->second;
+    } else if ( fold && ( stars == 1 ) && ( tokens.size( ) > 2 ) && ( tokens[ 0 ] == GLOB_STAR ) &&
+                ( tokens[ 1 ] == '.' ) ) {
+      index = suffixes.add( std::string( tokens.begin( ) + 2, tokens.end( ) ), index );
+    } else {
+      uint32_t node = 0;
+
+      for ( auto value : tokens ) {
+        uint32_t next = child( node, value );
+
+        if ( next == 0 ) {
+          next = static_cast< uint32_t >( token.size( ) );
+          token.push_back( value );
+          children.emplace_back( );
+          accept.push_back( -1 );
+
+          Children &list = children[ node ];
+          auto      edge = std::make_pair( value, next );
+          list.insert( std::lower_bound( list.begin( ), list.end( ), edge ), edge );
+
+          if ( ( value != GLOB_STAR ) && ( classes[ value ] == 0 ) ) {
+            classes[ value ] = width++;
+          }
+        }
+        node = next;
+      }
+
+      if ( accept[ node ] < 0 ) {
+        accept[ node ] = static_cast< int32_t >( index );
+        serial         = ++glob_serial;
+      }
+      index = static_cast< uint32_t >( accept[ node ] );
+    }
+
+    if ( index == owners.size( ) ) {
+      owners.emplace_back( );
+    }
+    return index;
+  }
+
+  void collect( const UriView::Span &span, std::vector< uint32_t > &matched ) const;
+};
+
+/**
+ * Lazily determinized DFA of one GlobProgram, owned by a single thread
+ *
+ * DFA states are closed sets of trie nodes.  Each set is stored once, in an arena, and found
+ * again through a hash index.  Transitions are indexed by the program's byte classes.  When
+ * the cache outgrows GLOB_CACHE_BYTES it is flushed, even in the middle of a component.
+ */
+struct GlobCache {
+  uint64_t                                      serial = 0;
+  uint64_t                                      used   = 0;
+  uint16_t                                      width  = 0;
+  uint32_t                                      start  = 0;
+  size_t                                        bytes  = 0;
+  std::vector< uint32_t >                       sets;         ///< node sets of all states
+  std::vector< uint32_t >                       bounds;       ///< state -> range in sets
+  std::vector< uint32_t >                       accepted;     ///< accepted globs of all states
+  std::vector< uint32_t >                       acceptBounds; ///< state -> range in accepted
+  std::vector< int32_t >                        next;         ///< state * width + class
+  std::unordered_multimap< uint64_t, uint32_t > index;        ///< set hash -> state
+  std::vector< uint32_t >                       scratch;
+
+  /**
+   * @brief Drop every state, keeping only the dead (0) and start states
+   * @param program compiled globs
+   */
+  void reset( const GlobProgram &program ) {
+    serial = program.serial;
+    width  = program.width;
+    bytes  = 0;
+    sets.clear( );
+    bounds.assign( 1, 0 );
+    accepted.clear( );
+    acceptBounds.assign( 1, 0 );
+    next.clear( );
+    index.clear( );
+
+    scratch.clear( );
+    intern( program, scratch );
+    scratch.assign( 1, 0 );
+    start = intern( program, scratch );
+  }
+
+  /**
+   * @brief Close a node set over star children and register it as a DFA state
+   * @param program compiled globs
+   * @param set trie nodes (modified)
+   * @return DFA state
+   */
+  uint32_t intern( const GlobProgram &program, std::vector< uint32_t > &set ) {
+    for ( size_t pos = 0; pos < set.size( ); ++pos ) {
+      uint32_t star = program.child( set[ pos ], GLOB_STAR );
+
+      if ( star != 0 ) {
+        set.push_back( star );
+      }
+    }
+
+    std::sort( set.begin( ), set.end( ) );
+    set.erase( std::unique( set.begin( ), set.end( ) ), set.end( ) );
+
+    uint64_t hash = 14695981039346656037ULL;
+    for ( auto node : set ) {
+      hash = ( hash ^ node ) * 1099511628211ULL;
+    }
+
+    auto range = index.equal_range( hash );
+    for ( auto iterator = range.first; iterator != range.second; ++iterator ) {
+      uint32_t state = iterator->second;
+
+      if ( ( bounds[ state + 1 ] - bounds[ state ] == set.size( ) ) &&
+           std::equal( set.begin( ), set.end( ), sets.begin( ) + bounds[ state ] ) ) {
+        return state;
+      }
+    }
+
+    uint32_t state = static_cast< uint32_t >( bounds.size( ) - 1 );
+    size_t   first = accepted.size( );
+
+    sets.insert( sets.end( ), set.begin( ), set.end( ) );
+    bounds.push_back( static_cast< uint32_t >( sets.size( ) ) );
+
+    for ( auto node : set ) {
+      if ( program.accept[ node ] >= 0 ) {
+        accepted.push_back( static_cast< uint32_t >( program.accept[ node ] ) );
+      }
+    }
+    acceptBounds.push_back( static_cast< uint32_t >( accepted.size( ) ) );
+
+    next.resize( next.size( ) + width, -1 );
+    index.emplace( hash, state );
+
+    bytes += ( set.size( ) + ( accepted.size( ) - first ) + width + 2 ) * sizeof( uint32_t ) +
+             4 * sizeof( void * ); // index node
+    return state;
+  }
+
+  /**
+   * @brief Follow (building if needed) a DFA transition
+   * @param program compiled globs
+   * @param state DFA state
+   * @param ch input character (already case folded)
+   * @return DFA state
+   */
+  uint32_t step( const GlobProgram &program, uint32_t state, unsigned char ch ) {
+    size_t  column = static_cast< size_t >( state ) * width + program.classes[ ch ];
+    int32_t cached = next[ column ];
+
+    if ( cached >= 0 ) {
+      return static_cast< uint32_t >( cached );
+    }
+
+    scratch.clear( );
+    for ( uint32_t pos = bounds[ state ]; pos < bounds[ state + 1 ]; ++pos ) {
+      uint32_t node   = sets[ pos ];
+      uint32_t target = program.child( node, ch );
+
+      if ( program.token[ node ] == GLOB_STAR ) {
+        scratch.push_back( node );
+      }
+      if ( target != 0 ) {
+        scratch.push_back( target );
+      }
+    }
+
+    if ( bytes > GLOB_CACHE_BYTES ) {
+      /* The source state is gone after the flush; only the target set is needed */
+      std::vector< uint32_t > target;
+      target.swap( scratch );
+      reset( program );
+      return intern( program, target );
+    }
+
+    uint32_t target = intern( program, scratch );
+    next[ column ]  = static_cast< int32_t >( target );
+    return target;
+  }
+
+  /**
+   * @brief Run the DFA over a component
+   * @param program compiled globs
+   * @param span component bytes
+   * @param matched receives the accepted glob indices
+   */
+  void run( const GlobProgram &     program,
+            const UriView::Span &   span,
+            std::vector< uint32_t > &matched ) {
+    uint32_t state = start;
+
+    for ( const char *pos = span.begin( ); ( pos != span.end( ) ) && ( state != 0 ); ++pos ) {
+      unsigned char ch = static_cast< unsigned char >( *pos );
+
+      if ( program.fold ) {
+        ch = static_cast< unsigned char >( tolower( ch ) );
+      }
+      state = step( program, state, ch );
+    }
+
+    matched.insert( matched.end( ), accepted.begin( ) + acceptBounds[ state ],
+                    accepted.begin( ) + acceptBounds[ state + 1 ] );
+  }
+
+  /**
+   * @brief Get the calling thread's cache for a program, recycling the least recently used
+   * @param program compiled globs
+   * @return DFA cache
+   */
+  static GlobCache &get( const GlobProgram &program ) {
+    static thread_local GlobCache caches[ GLOB_CACHES ];
+    static thread_local uint64_t  tick = 0;
+    GlobCache *                   victim = &caches[ 0 ];
+
+    for ( auto &cache : caches ) {
+      if ( cache.serial == program.serial ) {
+        cache.used = ++tick;
+        return cache;
+      }
+      if ( cache.used < victim->used ) {
+        victim = &cache;
+      }
+    }
+
+    victim->reset( program );
+    victim->used = ++tick;
+    return *victim;
+  }
+};
+
+/**
+ * @brief Find the globs matching a component
+ * @param span component bytes
+ * @param matched receives the matching glob indices
+ */
+void GlobProgram::collect( const UriView::Span &span, std::vector< uint32_t > &matched ) const {
+  if ( !exact.empty( ) || ( suffixes.suffix.size( ) > 1 ) ) {
+    std::string value( span.begin( ), span.end( ) );
+
+    if ( fold ) {
+      for ( auto &ch : value ) {
+        ch = static_cast< char >( tolower( static_cast< unsigned char >( ch ) ) );
+      }
+    }
+
+    auto literal = exact.find( value );
+    if ( literal != exact.end( ) ) {
+      matched.push_back( literal->second );
+    }
+    suffixes.match( value.data( ), value.size( ), matched );
+  }
+
+  if ( serial != 0 ) {
+    GlobCache::get( *this ).run( *this, span, matched );
+  }
+}
+
+/**
+ * UriPatternSet implementation
+ *
+ * Each pattern is led by its first constrained component in COMPONENTS order (the host being
+ * the most selective).  Only the globs of that component list the pattern, and the pattern's
+ * other components are checked against the globs matched there, so the work per URI follows
+ * the number of candidate patterns rather than the size of the set.
+ */
+class UriPatternSetImpl {
+ public:
+  enum Component { HOST, PATH, QUERY, SCHEME, COMPONENTS };
+
+  GlobProgram            programs[ COMPONENTS ];
+  std::vector< int32_t > globOf;     ///< per pattern and component: glob index, -1 if free
+  std::vector< size_t >  everything; ///< patterns with no constrained component
+  size_t                 patterns = 0;
+
+  UriPatternSetImpl( ) {
+    programs[ SCHEME ].fold = true;
+    programs[ HOST ].fold   = true;
+  }
+
+  void match( const UriView::Span ( &components )[ COMPONENTS ],
+              std::vector< size_t > &ids ) const {
+    std::vector< uint32_t > matched[ COMPONENTS ];
+
+    ids.clear( );
+
+    for ( int component = 0; component < COMPONENTS; ++component ) {
+      if ( !programs[ component ].owners.empty( ) ) {
+        programs[ component ].collect( components[ component ], matched[ component ] );
+        std::sort( matched[ component ].begin( ), matched[ component ].end( ) );
+      }
+    }
+
+    for ( int component = 0; component < COMPONENTS; ++component ) {
+      for ( auto glob : matched[ component ] ) {
+        for ( auto id : programs[ component ].owners[ glob ] ) {
+          bool accepted = true;
+
+          for ( int other = component + 1; accepted && ( other < COMPONENTS ); ++other ) {
+            int32_t required = globOf[ id * COMPONENTS + other ];
+
+            accepted = ( required < 0 ) ||
+                       std::binary_search( matched[ other ].begin( ), matched[ other ].end( ),
+                                           static_cast< uint32_t >( required ) );
+          }
+          if ( accepted ) {
+            ids.push_back( id );
+          }
+        }
+      }
+    }
+
+    ids.insert( ids.end( ), everything.begin( ), everything.end( ) );
+    std::sort( ids.begin( ), ids.end( ) );
+  }
+};
+
+UriPatternSet::UriPatternSet( )
+  : impl( new UriPatternSetImpl( ) ) {}
+
+UriPatternSet::~UriPatternSet( ) = default;
+
+/**
+ * @brief Find the next unescaped occurrence of any of the given characters
+ * @param pattern pattern string
+ * @param chars characters to look for
+ * @param pos starting position
+ * @return position, or npos
+ */
+static std::string::size_type pattern_find( const std::string &pattern,
+                                            const char *       chars,
+                                            std::string::size_type pos ) {
+  for ( ; pos < pattern.size( ); ++pos ) {
+    if ( pattern[ pos ] == '\\' ) {
+      ++pos;
+    } else if ( strchr( chars, pattern[ pos ] ) != nullptr ) {
+      return pos;
+    }
+  }
+  return std::string::npos;
+}
+
+/**
+ * @brief Add a pattern to the set
+ * @note Will throw a runtime error if the pattern is malformed
+ * @param pattern glob pattern
+ * @return pattern identifier
+ */
+size_t UriPatternSet::add( const std::string &pattern ) {
+  std::string            globs[ UriPatternSetImpl::COMPONENTS ];
+  bool                   present[ UriPatternSetImpl::COMPONENTS ] = { };
+  std::string::size_type pos                                      = 0;
+  std::string::size_type scheme = pattern_find( pattern, "/?", 0 );
+
+  if ( pattern.empty( ) ) {
+    throw std::runtime_error( "[" + pattern + "] is not a valid URI pattern" );
+  }
+
+  /* Only a "://" ahead of the first '/' or '?' separates a scheme */
+  if ( ( scheme != std::string::npos ) && ( scheme > 0 ) &&
+       ( pattern.compare( scheme - 1, 3, "://" ) == 0 ) ) {
+    if ( scheme == 1 ) {
+      throw std::runtime_error( "[" + pattern + "] is not a valid URI pattern" );
+    }
+    globs[ UriPatternSetImpl::SCHEME ]   = pattern.substr( 0, scheme - 1 );
+    present[ UriPatternSetImpl::SCHEME ] = true;
+    pos                                  = scheme + 2;
+  }
+
+  std::string::size_type path  = pattern_find( pattern, "/?", pos );
+  std::string::size_type query = pattern_find( pattern, "?", pos );
+
+  if ( path != pos ) {
+    globs[ UriPatternSetImpl::HOST ]   = pattern.substr( pos, std::min( path, query ) - pos );
+    present[ UriPatternSetImpl::HOST ] = true;
+  }
+
+  if ( ( path != std::string::npos ) && ( path != query ) ) {
+    globs[ UriPatternSetImpl::PATH ]   = pattern.substr( path, query - path );
+    present[ UriPatternSetImpl::PATH ] = true;
+  }
+
+  if ( query != std::string::npos ) {
+    globs[ UriPatternSetImpl::QUERY ]   = pattern.substr( query + 1 );
+    present[ UriPatternSetImpl::QUERY ] = true;
+  }
+
+  size_t id     = impl->patterns++;
+  bool   leader = true;
+
+  for ( int component = 0; component < UriPatternSetImpl::COMPONENTS; ++component ) {
+    int32_t glob = -1;
+
+    if ( present[ component ] && ( globs[ component ] != "*" ) ) {
+      glob = static_cast< int32_t >( impl->programs[ component ].add( globs[ component ] ) );
+
+      if ( leader ) {
+        impl->programs[ component ].owners[ glob ].push_back( id );
+        leader = false;
+      }
+    }
+    impl->globOf.push_back( glob );
+  }
+
+  if ( leader ) {
+    impl->everything.push_back( id );
+  }
+
+  return id;
+}
+
+/**
+ * @brief Get the number of patterns in the set
+ * @return pattern count
+ */
+size_t UriPatternSet::size( ) const {
+  return impl->patterns;
+}
+
+/**
+ * @brief Match a URI view against every pattern
+ * @param view URI components
+ * @param ids receives the matching pattern identifiers
+ * @return true if any pattern matched
+ */
+bool UriPatternSet::match( const UriView &view, std::vector< size_t > &ids ) const {
+  const UriView::Span components[ UriPatternSetImpl::COMPONENTS ] = {
+    view.host, view.resource, view.query, view.scheme };
+
+  impl->match( components, ids );
+  return !ids.empty( );
+}
+
+/**
+ * @brief Match a URI string against every pattern
+ * @param uri URI string
+ * @param ids receives the matching pattern identifiers
+ * @return true if any pattern matched
+ */
+bool UriPatternSet::match( const std::string &uri, std::vector< size_t > &ids ) const {
+  UriView view;
+
+  UriView::parse( uri, view );
+  return match( view, ids );
+}
+
+/**
+ * @brief Match a parsed URI against every pattern
+ * @note The path and query are compared in the form the Uri object returns them
+ * @param uri Uri object
+ * @param ids receives the matching pattern identifiers
+ * @return true if any pattern matched
+ */
+bool UriPatternSet::match( const Uri &uri, std::vector< size_t > &ids ) const {
+  std::string         scheme   = uri.scheme( );
+  std::string         host     = uri.host( );
+  std::string         resource = uri.resource( );
+  std::string         query    = uri.getComponent( Uri::QUERY );
+  const UriView::Span components[ UriPatternSetImpl::COMPONENTS ] = {
+    UriView::Span( host.data( ), host.size( ) ),
+    UriView::Span( resource.data( ), resource.size( ) ),
+    UriView::Span( query.data( ), query.size( ) ),
+    UriView::Span( scheme.data( ), scheme.size( ) ) };
+
+  impl->match( components, ids );
+  return !ids.empty( );
+}
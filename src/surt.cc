@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uri/surt.hh"
+#include "charclass.hh"
+
+#include <cctype>
+#include <cstring>
+#include <strings.h>
+
+/**
+ * Bounded key writer; counts the full length even once the buffer is exhausted
+ */
+struct SurtWriter {
+  char * out;
+  size_t capacity;
+  size_t length;
+
+  void put( char ch ) {
+    if ( length < capacity ) {
+      out[ length ] = ch;
+    }
+    ++length;
+  }
+
+  void put( const char *data, size_t size ) {
+    for ( size_t index = 0; index < size; ++index ) {
+      put( data[ index ] );
+    }
+  }
+
+  void lower( const char *data, size_t size ) {
+    for ( size_t index = 0; index < size; ++index ) {
+      put( static_cast< char >( tolower( static_cast< unsigned char >( data[ index ] ) ) ) );
+    }
+  }
+};
+
+/**
+ * @brief Check a scheme name, ignoring case
+ * @param scheme scheme span
+ * @param name lowercase scheme name
+ * @return true if equal
+ */
+static bool surt_scheme( const UriView::Span &scheme, const char *name ) {
+  size_t length = strlen( name );
+  return ( scheme.size == length ) && !strncasecmp( scheme.data, name, length );
+}
+
+/**
+ * @brief Check for the scheme's default port
+ * @param scheme scheme span
+ * @param port port span
+ * @return true if the port can be dropped
+ */
+static bool surt_default_port( const UriView::Span &scheme, const UriView::Span &port ) {
+  if ( port.empty( ) ) {
+    return true;
+  }
+
+  if ( port == "80" ) {
+    return surt_scheme( scheme, "http" ) || surt_scheme( scheme, "ws" );
+  } else if ( port == "443" ) {
+    return surt_scheme( scheme, "https" ) || surt_scheme( scheme, "wss" );
+  } else if ( port == "21" ) {
+    return surt_scheme( scheme, "ftp" );
+  }
+  return false;
+}
+
+/**
+ * @brief Write the host with its labels reversed
+ * @param writer key writer
+ * @param host host span
+ */
+static void surt_host( SurtWriter &writer, const UriView::Span &host ) {
+  const char *begin = host.begin( );
+  const char *end   = host.end( );
+
+  while ( ( end != begin ) && ( end[ -1 ] == '.' ) ) {
+    --end;
+  }
+
+  bool numeric = true;
+  for ( const char *pos = begin; pos != end; ++pos ) {
+    if ( !uri_is( static_cast< unsigned char >( *pos ), URI_CC_DIGIT ) && ( *pos != '.' ) ) {
+      numeric = false;
+      break;
+    }
+  }
+
+  if ( numeric || ( ( begin != end ) && ( *begin == '[' ) ) ) {
+    writer.lower( begin, end - begin );
+    return;
+  }
+
+  const char *label = end;
+
+  while ( label != begin ) {
+    const char *start = label;
+
+    while ( ( start != begin ) && ( start[ -1 ] != '.' ) ) {
+      --start;
+    }
+
+    if ( label != end ) {
+      writer.put( ',' );
+    }
+    writer.lower( start, label - start );
+
+    label = ( start == begin ) ? begin : start - 1;
+  }
+}
+
+/**
+ * @brief Write the key of a split URI
+ * @param view URI components
+ * @param out output buffer
+ * @param capacity output buffer size
+ * @return key length
+ */
+size_t Surt::key( const UriView &view, char *out, size_t capacity ) {
+  SurtWriter writer{ out, capacity, 0 };
+  bool       web = surt_scheme( view.scheme, "http" ) || surt_scheme( view.scheme, "https" );
+
+  if ( view.scheme.present( ) && !web ) {
+    writer.lower( view.scheme.data, view.scheme.size );
+    writer.put( ':' );
+  }
+
+  if ( view.authority.present( ) ) {
+    surt_host( writer, view.host );
+
+    if ( !surt_default_port( view.scheme, view.port ) ) {
+      writer.put( ':' );
+      writer.put( view.port.data, view.port.size );
+    }
+
+    writer.put( ')' );
+
+    if ( view.resource.empty( ) ) {
+      writer.put( '/' );
+    }
+  }
+
+  writer.put( view.resource.data, view.resource.size );
+
+  if ( view.query.present( ) ) {
+    writer.put( '?' );
+    writer.put( view.query.data, view.query.size );
+  }
+
+  return writer.length;
+}
+
+/**
+ * @brief Write the key of a URI string
+ * @param data URI string
+ * @param size URI length
+ * @param out output buffer
+ * @param capacity output buffer size
+ * @return key length
+ */
+size_t Surt::key( const char *data, size_t size, char *out, size_t capacity ) {
+  UriView view;
+
+  UriView::parse( data, size, view );
+  return key( view, out, capacity );
+}
+
+/**
+ * @brief Get the key of a URI string
+ * @param uri URI string
+ * @return SURT key
+ */
+std::string Surt::key( const std::string &uri ) {
+  std::string out( uri.size( ) + 4, '\0' );
+
+  out.resize( key( uri.data( ), uri.size( ), &out[ 0 ], out.size( ) ) );
+  return out;
+}
+
+/**
+ * @brief Generate the keys of many URIs into one contiguous buffer
+ * @param uris URI strings
+ * @param buffer receives the keys back to back
+ * @param offsets receives uris.size() + 1 offsets
+ */
+void Surt::keys( const std::vector< std::string > &uris,
+                 std::string &                     buffer,
+                 std::vector< size_t > &           offsets ) {
+  size_t total = 0;
+
+  for ( auto &uri : uris ) {
+    total += uri.size( ) + 4;
+  }
+
+  buffer.resize( total );
+  offsets.resize( uris.size( ) + 1 );
+
+  size_t pos = 0;
+
+  for ( size_t index = 0; index < uris.size( ); ++index ) {
+    offsets[ index ] = pos;
+    pos += key( uris[ index ].data( ), uris[ index ].size( ), &buffer[ 0 ] + pos,
+                uris[ index ].size( ) + 4 );
+  }
+
+  offsets.back( ) = pos;
+  buffer.resize( pos );
+}
@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uri/template.hh"
+#include "charclass.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+/**
+ * Expansion behaviour of an expression operator (RFC 6570 appendix A)
+ */
+struct TemplateOperator {
+  char first;    ///< character emitted before the first defined value, 0 for none
+  char sep;      ///< separator between values
+  bool named;    ///< emit "name=" pairs
+  bool ifemp;    ///< emit "=" for empty named values
+  bool reserved; ///< allow reserved characters and pct-encoded triplets through
+};
+
+/**
+ * @brief Get the expansion behaviour of an operator
+ * @param op operator character, 0 for simple string expansion
+ * @return operator behaviour
+ */
+static TemplateOperator template_operator( char op ) {
+  switch ( op ) {
+    case '+': return TemplateOperator{ 0, ',', false, false, true };
+    case '#': return TemplateOperator{ '#', ',', false, false, true };
+    case '.': return TemplateOperator{ '.', '.', false, false, false };
+    case '/': return TemplateOperator{ '/', '/', false, false, false };
+    case ';': return TemplateOperator{ ';', ';', true, false, false };
+    case '?': return TemplateOperator{ '?', '&', true, true, false };
+    case '&': return TemplateOperator{ '&', '&', true, true, false };
+    default: return TemplateOperator{ 0, ',', false, false, false };
+  }
+}
+
+/**
+ * @brief Percent-encode a value into the output buffer
+ * @param out output position (at least 3 * size bytes)
+ * @param data value
+ * @param size value length
+ * @param reserved allow reserved characters and pct-encoded triplets through unchanged
+ * @return position following the encoded value
+ */
+static char *template_encode( char *out, const char *data, size_t size, bool reserved ) {
+  for ( size_t index = 0; index < size; ++index ) {
+    unsigned char ch = static_cast< unsigned char >( data[ index ] );
+
+    if ( uri_is( ch, URI_CC_UNRESERVED ) || ( reserved && uri_is( ch, URI_CC_RESERVED ) ) ) {
+      *out++ = static_cast< char >( ch );
+    } else if ( reserved && uri_is_pct_triplet( data + index, size - index ) ) {
+      memcpy( out, data + index, 3 );
+      out += 3;
+      index += 2;
+    } else {
+      out = uri_pct_encode( out, ch );
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief Length of the first @p prefix characters (UTF-8 code points) of a value
+ * @param value value
+ * @param prefix prefix modifier, 0 for the whole value
+ * @return byte length
+ */
+static size_t template_prefix( const std::string &value, size_t prefix ) {
+  if ( prefix == 0 ) {
+    return value.size( );
+  }
+
+  for ( size_t index = 0; index < value.size( ); ++index ) {
+    if ( ( static_cast< unsigned char >( value[ index ] ) & 0xC0 ) != 0x80 ) {
+      if ( prefix-- == 0 ) {
+        return index;
+      }
+    }
+  }
+  return value.size( );
+}
+
+/**
+ * @brief Check a template variable name (RFC 6570 section 2.3)
+ * @param name variable name
+ * @return true if valid
+ */
+static bool template_varname( const std::string &name ) {
+  if ( name.empty( ) || ( name.front( ) == '.' ) || ( name.back( ) == '.' ) ) {
+    return false;
+  }
+
+  for ( size_t index = 0; index < name.size( ); ++index ) {
+    unsigned char ch = static_cast< unsigned char >( name[ index ] );
+
+    if ( ch == '%' ) {
+      if ( !uri_is_pct_triplet( name.data( ) + index, name.size( ) - index ) ) {
+        return false;
+      }
+      index += 2;
+    } else if ( ch == '.' ) {
+      if ( name[ index + 1 ] == '.' ) {
+        return false;
+      }
+    } else if ( !uri_is( ch, URI_CC_ALPHA | URI_CC_DIGIT ) && ( ch != '_' ) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Template compiling constructor
+ * @note Will throw a runtime error if the template is malformed
+ * @param tmpl template string
+ */
+UriTemplate::UriTemplate( const std::string &tmpl )
+  : literalSize( 0 ) {
+  auto fail = [&tmpl]( const std::string &why ) {
+    return std::runtime_error( "[" + tmpl + "] is not a valid URI template: " + why );
+  };
+  std::string::size_type index = 0;
+
+  while ( index < tmpl.size( ) ) {
+    std::string::size_type open = tmpl.find( '{', index );
+
+    if ( open != index ) {
+      std::string::size_type end = ( open == std::string::npos ) ? tmpl.size( ) : open;
+      Instruction            literal{ false, 0, std::string( ), { } };
+
+      if ( tmpl.find( '}', index ) < end ) {
+        throw fail( "unexpected '}'" );
+      }
+
+      literal.literal.resize( ( end - index ) * 3 );
+      literal.literal.resize(
+        template_encode( &literal.literal[ 0 ], tmpl.data( ) + index, end - index, true ) -
+        literal.literal.data( ) );
+
+      literalSize += literal.literal.size( );
+      program.push_back( std::move( literal ) );
+      index = end;
+      continue;
+    }
+
+    std::string::size_type close = tmpl.find( '}', open );
+
+    if ( ( close == std::string::npos ) || ( tmpl.find( '{', open + 1 ) < close ) ) {
+      throw fail( "unterminated expression" );
+    }
+
+    Instruction            expression{ true, 0, std::string( ), { } };
+    std::string::size_type pos = open + 1;
+
+    switch ( tmpl[ pos ] ) { // clang-format off
+      case '+': case '#': case '.': case '/': case ';': case '?': case '&':
+        expression.op = tmpl[ pos++ ];
+        break;
+      case '=': case ',': case '!': case '@': case '|':
+        throw fail( "reserved operator" );
+      default:
+        break;
+    } // clang-format on
+
+    while ( pos <= close ) {
+      std::string::size_type comma = tmpl.find( ',', pos );
+      std::string            spec  = tmpl.substr( pos, std::min( comma, close ) - pos );
+      VarSpec                varspec{ 0, 0, false };
+      std::string::size_type colon = spec.find( ':' );
+
+      if ( !spec.empty( ) && ( spec.back( ) == '*' ) ) {
+        varspec.explode = true;
+        spec.pop_back( );
+      } else if ( colon != std::string::npos ) {
+        std::string digits = spec.substr( colon + 1 );
+
+        if ( digits.empty( ) || ( digits.size( ) > 4 ) || ( digits[ 0 ] == '0' ) ||
+             ( digits.find_first_not_of( "0123456789" ) != std::string::npos ) ) {
+          throw fail( "invalid prefix modifier" );
+        }
+
+        varspec.prefix = std::stoul( digits );
+        spec.erase( colon );
+      }
+
+      if ( !template_varname( spec ) ) {
+        throw fail( "invalid variable name" );
+      }
+
+      varspec.index = std::find( names.begin( ), names.end( ), spec ) - names.begin( );
+      if ( varspec.index == names.size( ) ) {
+        names.push_back( spec );
+      }
+
+      expression.varspecs.push_back( varspec );
+      pos = std::min( comma, close ) + 1;
+    }
+
+    program.push_back( std::move( expression ) );
+    index = close + 1;
+  }
+}
+
+/**
+ * @brief Look up the index of a template variable
+ * @param name variable name
+ * @return variable index, or -1 if the template does not reference it
+ */
+int UriTemplate::variable( const std::string &name ) const {
+  auto iterator = std::find( names.begin( ), names.end( ), name );
+  return ( iterator == names.end( ) ) ? -1 : static_cast< int >( iterator - names.begin( ) );
+}
+
+/**
+ * @brief Expand the template
+ * @param vars variable values by name
+ * @return expanded URI string
+ */
+std::string UriTemplate::expand( const Variables &vars ) const {
+  std::string out;
+  expand( vars, out );
+  return out;
+}
+
+/**
+ * @brief Expand the template, appending to an output buffer
+ * @param vars variable values by name
+ * @param out output buffer
+ * @return number of bytes appended
+ */
+size_t UriTemplate::expand( const Variables &vars, std::string &out ) const {
+  std::vector< const Value * > values( names.size( ), nullptr );
+
+  for ( size_t index = 0; index < names.size( ); ++index ) {
+    auto iterator = vars.find( names[ index ] );
+    if ( iterator != vars.end( ) ) {
+      values[ index ] = &iterator->second;
+    }
+  }
+
+  return run( values.data( ), out );
+}
+
+/**
+ * @brief Expand the template from values bound by variable index
+ * @param values values, indexed as variables()
+ * @param out output buffer
+ * @return number of bytes appended
+ */
+size_t UriTemplate::expand( const std::vector< Value > &values, std::string &out ) const {
+  std::vector< const Value * > bound( names.size( ), nullptr );
+
+  for ( size_t index = 0; ( index < names.size( ) ) && ( index < values.size( ) ); ++index ) {
+    bound[ index ] = &values[ index ];
+  }
+
+  return run( bound.data( ), out );
+}
+
+/**
+ * @brief Expand the template into a parsed URI
+ * @param vars variable values by name
+ * @throw runtime error on parsing or memory allocation
+ * @return URI object
+ */
+Uri *UriTemplate::expandUri( const Variables &vars ) const {
+  return Uri::parse( expand( vars ) );
+}
+
+/**
+ * @brief Run the expansion program
+ *
+ * The output is sized once to an upper bound of the expansion (every value byte
+ * percent-encoded), written in place and then trimmed to the written length.
+ *
+ * @param values bound variable values, indexed as names; nullptr for undefined
+ * @param out output buffer
+ * @return number of bytes appended
+ */
+size_t UriTemplate::run( const Value *const *values, std::string &out ) const {
+  size_t bound = literalSize;
+
+  for ( auto &instruction : program ) {
+    for ( auto &varspec : instruction.varspecs ) {
+      const Value *value = values[ varspec.index ];
+      size_t       name  = names[ varspec.index ].size( ) + 2;
+
+      if ( value == nullptr ) {
+        continue;
+      }
+
+      switch ( value->type( ) ) {
+        case Value::STRING: bound += name + value->str( ).size( ) * 3; break;
+        case Value::LIST:
+          for ( auto &item : value->items( ) ) {
+            bound += name + item.size( ) * 3;
+          }
+          break;
+        case Value::MAP:
+          for ( auto &pair : value->pairs( ) ) {
+            bound += name + ( pair.first.size( ) + pair.second.size( ) ) * 3 + 1;
+          }
+          break;
+        default: break;
+      }
+    }
+    bound += instruction.varspecs.size( ) + 1;
+  }
+
+  size_t base = out.size( );
+  out.resize( base + bound );
+
+  char *start = &out[ 0 ] + base;
+  char *pos   = start;
+
+  for ( auto &instruction : program ) {
+    if ( !instruction.expression ) {
+      memcpy( pos, instruction.literal.data( ), instruction.literal.size( ) );
+      pos += instruction.literal.size( );
+      continue;
+    }
+
+    TemplateOperator op    = template_operator( instruction.op );
+    bool             first = true;
+
+    for ( auto &varspec : instruction.varspecs ) {
+      const Value *      value = values[ varspec.index ];
+      const std::string &name  = names[ varspec.index ];
+
+      if ( ( value == nullptr ) || !value->defined( ) ) {
+        continue;
+      }
+
+      if ( first ) {
+        if ( op.first ) {
+          *pos++ = op.first;
+        }
+        first = false;
+      } else {
+        *pos++ = op.sep;
+      }
+
+      auto named = [&]( const std::string &item ) {
+        memcpy( pos, name.data( ), name.size( ) );
+        pos += name.size( );
+        if ( !item.empty( ) || op.ifemp ) {
+          *pos++ = '=';
+        }
+      };
+
+      if ( value->type( ) == Value::STRING ) {
+        const std::string &str = value->str( );
+
+        if ( op.named ) {
+          named( str );
+        }
+        pos = template_encode( pos, str.data( ), template_prefix( str, varspec.prefix ),
+                               op.reserved );
+      } else if ( !varspec.explode ) {
+        bool composite = false;
+
+        if ( op.named ) {
+          memcpy( pos, name.data( ), name.size( ) );
+          pos += name.size( );
+          *pos++ = '=';
+        }
+
+        if ( value->type( ) == Value::LIST ) {
+          for ( auto &item : value->items( ) ) {
+            if ( composite ) {
+              *pos++ = ',';
+            }
+            pos       = template_encode( pos, item.data( ), item.size( ), op.reserved );
+            composite = true;
+          }
+        } else {
+          for ( auto &pair : value->pairs( ) ) {
+            if ( composite ) {
+              *pos++ = ',';
+            }
+            pos    = template_encode( pos, pair.first.data( ), pair.first.size( ), op.reserved );
+            *pos++ = ',';
+            pos = template_encode( pos, pair.second.data( ), pair.second.size( ), op.reserved );
+            composite = true;
+          }
+        }
+      } else if ( value->type( ) == Value::LIST ) {
+        bool composite = false;
+
+        for ( auto &item : value->items( ) ) {
+          if ( composite ) {
+            *pos++ = op.sep;
+          }
+          if ( op.named ) {
+            named( item );
+          }
+          pos       = template_encode( pos, item.data( ), item.size( ), op.reserved );
+          composite = true;
+        }
+      } else {
+        bool composite = false;
+
+        for ( auto &pair : value->pairs( ) ) {
+          if ( composite ) {
+            *pos++ = op.sep;
+          }
+          pos = template_encode( pos, pair.first.data( ), pair.first.size( ), op.reserved );
+          if ( !op.named || !pair.second.empty( ) || op.ifemp ) {
+            *pos++ = '=';
+          }
+          pos = template_encode( pos, pair.second.data( ), pair.second.size( ), op.reserved );
+          composite = true;
+        }
+      }
+    }
+  }
+
+  out.resize( base + ( pos - start ) );
+  return pos - start;
+}
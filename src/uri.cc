@@ -24,7 +24,10 @@
  */
 
 #include "uri/uri.hh"
+#include "charclass.hh"
 
+#include <atomic>
+#include <iterator>
 #include <map>
 #include <netdb.h>
 #include <sstream>
@@ -119,19 +122,44 @@ void Uri::registerScheme( const std::string &scheme,
 
 /**
  * Uri Implementation
+ *
+ * Components and query fields are immutable snapshots shared between copies, so clone() only
+ * bumps reference counts.  A mutation copies the map it touches (component values themselves
+ * stay shared) unless this instance is its sole owner.
  */
 class UriImpl : public Uri {
   friend std::string default_build( const Uri &uri );
 
  private:
-  std::map< std::string, std::string >      components;
-  std::multimap< std::string, std::string > queryFields;
-  bool                                      isOpaque;
-  bool                                      hasPort;
+  typedef std::map< std::string, std::shared_ptr< const std::string > > ComponentMap;
+  typedef std::multimap< std::string, std::string >                     QueryMap;
+
+  std::shared_ptr< ComponentMap >      components;
+  std::shared_ptr< QueryMap >          queryFields;
+  std::shared_ptr< const std::string > cached; ///< toString( ) result, null when stale
+  bool                                 isOpaque;
+  bool                                 hasPort;
+
+  /**
+   * @brief Get a snapshot for writing, copying it first if it is shared
+   * @param snapshot components or query fields
+   * @return snapshot owned solely by this instance
+   */
+  template < class T >
+  static T &writable( std::shared_ptr< T > &snapshot ) {
+    if ( snapshot.use_count( ) != 1 ) {
+      snapshot = std::make_shared< T >( *snapshot );
+    } else {
+      /* Order our writes after the reads of the copy that released its reference */
+      std::atomic_thread_fence( std::memory_order_acquire );
+    }
+    return *snapshot;
+  }
 
   void clear( ) {
-    queryFields.clear( );
-    components.clear( );
+    queryFields = std::make_shared< QueryMap >( );
+    components  = std::make_shared< ComponentMap >( );
+    cached.reset( );
     isOpaque = true;
     hasPort  = false;
   }
@@ -176,6 +204,13 @@ class UriImpl : public Uri {
     }
   }
 
+  /**
+   * @brief Copy the URI
+   * @note Constant time; the copy shares this URI's snapshots until either is modified
+   * @return independent copy of this URI
+   */
+  Uri *clone( ) const override { return new UriImpl( *this ); }
+
   /**
    * @brief Get the component value
    * @param name field name
@@ -184,16 +219,21 @@ class UriImpl : public Uri {
   std::string getComponent( const std::string &name ) const override {
     std::string value;
 
-    if ( name != Uri::QUERY ) {
-      auto component = components.find( name );
-      if ( component != components.end( ) ) {
-        value = component->second;
+    if ( name == Uri::URI ) {
+      if ( cached ) {
+        value = *cached;
+      }
+    } else if ( name != Uri::QUERY ) {
+      auto component = components->find( name );
+      if ( component != components->end( ) ) {
+        value = *component->second;
       }
-    } else if ( !queryFields.empty( ) ) {
+    } else if ( !queryFields->empty( ) ) {
       std::stringstream ss;
 
-      for ( auto &it : queryFields ) {
-        ss << escape( ( it ).first ) << "=" << escape( ( it ).second ) << "&";
+      for ( auto &it : *queryFields ) {
+        ss << escape( ( it ).first, ENCODE_QUERY_KEY ) << "="
+           << escape( ( it ).second, ENCODE_QUERY ) << "&";
       }
 
       value = ss.str( );
@@ -209,7 +249,6 @@ class UriImpl : public Uri {
    */
   std::string setComponent( const std::string &name, std::string value ) override {
     std::string old;
-    auto        component = components.find( name );
 
     if ( name == Uri::SCHEME ) {
       struct servent *service = getservbyname( value.c_str( ), nullptr );
@@ -222,14 +261,21 @@ class UriImpl : public Uri {
       hasPort = ( ( value.length( ) > 0 ) && ( value != "0" ) );
     }
 
-    if ( component != components.end( ) ) {
-      old               = component->second;
-      component->second = unescape( value );
-    } else {
-      components[ name ] = unescape( value );
+    cached.reset( );
+
+    if ( name == Uri::URI ) {
+      return old;
     }
 
-    components[ URI ] = "";
+    auto &snapshot  = writable( components );
+    auto  component = snapshot.find( name );
+
+    if ( component != snapshot.end( ) ) {
+      old               = *component->second;
+      component->second = std::make_shared< const std::string >( unescape( value ) );
+    } else {
+      snapshot[ name ] = std::make_shared< const std::string >( unescape( value ) );
+    }
 
     return old;
   }
@@ -253,11 +299,11 @@ class UriImpl : public Uri {
          << format.build( *this );             //
 
       if ( !fragment.empty( ) ) {
-        ss << "#" << fragment;
+        ss << "#" << escape( fragment, ENCODE_FRAGMENT );
       }
 
-      uri                     = ss.str( );
-      this->components[ URI ] = uri;
+      uri    = ss.str( );
+      cached = std::make_shared< const std::string >( uri );
     }
 
     return uri;
@@ -277,6 +323,7 @@ class UriImpl : public Uri {
   bool opaque( bool opaque ) override {
     bool tmp = isOpaque;
     isOpaque = opaque;
+    cached.reset( );
     return tmp;
   }
 
@@ -287,7 +334,7 @@ class UriImpl : public Uri {
    */
   std::vector< std::string > getQuery( const std::string &key ) const override {
     std::vector< std::string > query;
-    auto                       pair = queryFields.equal_range( key );
+    auto                       pair = queryFields->equal_range( key );
 
     for ( auto iterator = pair.first; iterator != pair.second; ++iterator ) {
       query.push_back( iterator->second );
@@ -298,7 +345,7 @@ class UriImpl : public Uri {
 
   std::unordered_map< std::string, std::string > getQuery( ) const override {
     std::unordered_map< std::string, std::string > query;
-    for ( auto &it : queryFields ) {
+    for ( auto &it : *queryFields ) {
       if ( query.find( it.first ) == query.end( ) ) {
         query.emplace( std::make_pair( ( it ).first, ( it ).second ) );
       }
@@ -312,7 +359,10 @@ class UriImpl : public Uri {
    * @return true on success, false on failure
    */
   bool removeQuery( const std::string &key ) override {
-    queryFields.erase( key );
+    if ( queryFields->count( key ) != 0 ) {
+      writable( queryFields ).erase( key );
+      cached.reset( );
+    }
     return true;
   }
 
@@ -323,11 +373,15 @@ class UriImpl : public Uri {
    * @return true on success, or false on failure
    */
   bool removeQuery( const std::string &key, const std::string &value ) override {
-    auto pair = queryFields.equal_range( key );
+    auto pair = queryFields->equal_range( key );
 
     for ( auto iterator = pair.first; iterator != pair.second; ++iterator ) {
       if ( iterator->second == value ) {
-        queryFields.erase( iterator );
+        size_t offset = std::distance( queryFields->begin( ), iterator );
+        auto  &fields = writable( queryFields );
+
+        fields.erase( std::next( fields.begin( ), offset ) );
+        cached.reset( );
         return true;
       }
     }
@@ -342,11 +396,13 @@ class UriImpl : public Uri {
    * @return true on success, or false on failure
    */
   bool addQuery( std::string key, std::string value ) override {
-    size_t size = queryFields.size( );
+    auto  &fields = writable( queryFields );
+    size_t size   = fields.size( );
 
-    queryFields.insert( { std::move( unescape( key ) ), std::move( unescape( value ) ) } );
+    fields.insert( { std::move( unescape( key ) ), std::move( unescape( value ) ) } );
+    cached.reset( );
 
-    return queryFields.size( ) > size;
+    return fields.size( ) > size;
   }
 };
 
@@ -360,6 +416,37 @@ Uri *Uri::parse( const std::string &uri ) {
   return new UriImpl( uri );
 }
 
+/**
+ * Parse a URI, optionally validating it first
+ * @param uri URI to parse
+ * @param strict reject URIs that fail Uri::validate()
+ * @throw runtime error on validation, parsing or memory allocation
+ * @return URI object
+ */
+Uri *Uri::parse( const std::string &uri, bool strict ) {
+  std::string reason;
+
+  if ( strict && !validate( uri, &reason ) ) {
+    throw std::runtime_error( "[" + uri + "] is not a valid URI: " + reason );
+  }
+  return new UriImpl( uri );
+}
+
+/**
+ * @brief Escape a value with a component's percent-encoding set
+ * @note The escaped length is counted first so the result is allocated once
+ * @param value raw value
+ * @param set characters to escape
+ * @return escaped value
+ */
+std::string Uri::escape( const std::string &value, EncodeSet set ) {
+  const uint8_t *table = uri_encode_set( set );
+  std::string    escaped( uri_encoded_size( table, value.data( ), value.size( ) ), '\0' );
+
+  uri_encode( &escaped[ 0 ], table, value.data( ), value.size( ) );
+  return escaped;
+}
+
 /**
  * @brief Default Uri parser
  * @param uri Uri object
@@ -367,12 +454,49 @@ Uri *Uri::parse( const std::string &uri ) {
  * @return true on success, false on failure
  */
 static bool default_parse( Uri &uri, std::string value ) {
-  std::string::size_type index = value.find( ':' );
+  std::string::size_type index    = value.find( ':' );
+  std::string::size_type fragment = value.find( '#' );
   std::string::size_type query{ };
-  std::string::size_type fragment = value.rfind( '#' );
   std::string::size_type resource{ };
 
-  if ( index == std::string::npos ) {
+  /*
+   * The fragment and query are cut off first, so neither leaks into the path or authority
+   */
+  if ( fragment != std::string::npos ) {
+    uri.fragment( value.substr( fragment + 1 ) );
+    value.erase( fragment );
+  }
+
+  query = value.find( '?' );
+
+  if ( query != std::string::npos ) {
+    std::vector< std::string > pairs;
+    auto split = []( std::vector< std::string > &parts, std::string value, std::string delim ) {
+      std::string::size_type last = 0;
+      for ( std::string::size_type pos = 0; ( pos = value.find( delim, pos ) ) != std::string::npos;
+            ++pos ) {
+        parts.push_back( value.substr( last, pos - last ) );
+        last = pos + delim.length( );
+      }
+      parts.push_back( value.substr( last ) );
+    };
+
+    split( pairs, value.substr( query + 1 ), "&" );
+
+    for ( auto &each : pairs ) {
+      std::string::size_type equals = each.find( '=' );
+
+      if ( equals != std::string::npos ) {
+        uri.addQuery( each.substr( 0, equals ), each.substr( equals + 1 ) );
+      } else {
+        uri.addQuery( each, "" );
+      }
+    }
+
+    value.erase( query );
+  }
+
+  if ( ( index == std::string::npos ) || ( index >= value.length( ) ) ) {
     /*
      * The entirety of the value is the resource... usually a path name
      */
@@ -383,10 +507,8 @@ static bool default_parse( Uri &uri, std::string value ) {
 
   ++index;
 
-  query = value.find( '?' );
-
   if ( uri.opaque( ) ) {
-    uri.resource( value.substr( index, query ) );
+    uri.resource( value.substr( index ) );
   } else {
     if ( uri.scheme( ) == "file" ) {
       if ( value[ index ] == '/' ) {
@@ -404,96 +526,54 @@ static bool default_parse( Uri &uri, std::string value ) {
 
     if ( resource != std::string::npos ) {
       authority_parse( uri, value.substr( index, resource - index ) );
-
-      if ( query != std::string::npos ) {
-        uri.resource( value.substr( resource, query - resource ) );
-      } else {
-        uri.resource( value.substr( resource ) );
-      }
+      uri.resource( value.substr( resource ) );
     } else {
       authority_parse( uri, value.substr( index ) );
     }
   }
 
-  if ( fragment != std::string::npos ) {
-    uri.fragment( value.substr( fragment ) );
-  }
-
-  if ( query != std::string::npos ) {
-    std::vector< std::string > pairs;
-    auto split = []( std::vector< std::string > &parts, std::string value, std::string delim ) {
-      std::string::size_type last = 0;
-      for ( std::string::size_type pos = 0; ( pos = value.find( delim, pos ) ) != std::string::npos;
-            ++pos ) {
-        parts.push_back( value.substr( last, pos - last ) );
-        last = pos + delim.length( );
-      }
-      parts.push_back( value.substr( last ) );
-    };
-
-    value = value.substr( query + 1, fragment );
-
-    split( pairs, value, "&" );
-
-    for ( auto &each : pairs ) {
-      std::vector< std::string > nvp;
-
-      split( nvp, each, "=" );
-
-      uri.addQuery( nvp[ 0 ], ( nvp.size( ) > 1 ) ? nvp[ 1 ] : "" );
-    }
-  }
-
   return true;
 }
 
 /**
  * @brief Generic default Uri string builder
+ * @note Each component is escaped with its own encoding set; the fragment is added by toString()
  * @param uri Uri object
  * @return stringified Uri
  */
 static std::string default_build( const Uri &uri ) {
-  std::stringstream ss( uri.scheme( ) );
-  std::string       resource = uri.resource( );
-  std::string       fragment = uri.fragment( );
-  std::string       query    = uri.getComponent( Uri::QUERY );
+  std::string value;
+  std::string query = uri.getComponent( Uri::QUERY );
 
   if ( !uri.opaque( ) ) {
     std::string user = uri.user( );
     std::string pass = uri.password( );
-    std::string host = uri.host( );
     std::string port = uri.getComponent( Uri::PORT );
 
     if ( !user.empty( ) ) {
-      ss << user;
+      value += Uri::escape( user, Uri::ENCODE_USERINFO );
 
       if ( !pass.empty( ) ) {
-        ss << ":" << pass;
+        value += ":" + Uri::escape( pass, Uri::ENCODE_USERINFO );
       }
 
-      ss << "@";
+      value += "@";
     }
 
-    ss << host;
+    value += uri.host( );
 
     if ( dynamic_cast< const UriImpl * >( &uri )->hasPort ) {
       if ( !port.empty( ) ) {
-        ss << ":" << port;
+        value += ":" + port;
       }
     }
+  }
 
-    ss << resource;
-
-    if ( !query.empty( ) ) {
-      ss << "?" << query;
-    }
+  value += Uri::escape( uri.resource( ), Uri::ENCODE_PATH );
 
-    if ( !fragment.empty( ) ) {
-      ss << "#" << fragment;
-    }
-  } else {
-    ss << resource;
+  if ( !query.empty( ) ) {
+    value += "?" + query;
   }
 
-  return ss.str( );
+  return value;
 }
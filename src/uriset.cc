@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uri/uriset.hh"
+#include "uri/view.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+/**
+ * @brief Append an unsigned LEB128 value
+ * @param data output
+ * @param value value to append
+ */
+static void uriset_put( std::string &data, uint64_t value ) {
+  while ( value >= 0x80 ) {
+    data.push_back( static_cast< char >( ( value & 0x7F ) | 0x80 ) );
+    value >>= 7;
+  }
+  data.push_back( static_cast< char >( value ) );
+}
+
+/**
+ * @brief Read an unsigned LEB128 value
+ * @param data input
+ * @param offset read position, advanced past the value
+ * @return value
+ */
+static uint64_t uriset_get( const std::string &data, size_t &offset ) {
+  uint64_t value = 0;
+  int      shift = 0;
+
+  for ( ;; ) {
+    uint8_t byte = static_cast< uint8_t >( data[ offset++ ] );
+
+    value |= static_cast< uint64_t >( byte & 0x7F ) << shift;
+    if ( !( byte & 0x80 ) ) {
+      return value;
+    }
+    shift += 7;
+  }
+}
+
+/**
+ * @brief Decode one entry
+ *
+ * A block head is stored as its length and bytes; the other entries as the length of the
+ * prefix and suffix they share with the previous entry, then the bytes in between.
+ *
+ * @param data encoded entries
+ * @param offset entry position, advanced past the entry
+ * @param head entry starts a block (stored in full)
+ * @param tail previous entry in, decoded entry out
+ */
+static void uriset_decode( const std::string &data, size_t &offset, bool head, std::string &tail ) {
+  size_t prefix = head ? 0 : uriset_get( data, offset );
+  size_t suffix = head ? 0 : uriset_get( data, offset );
+  size_t middle = uriset_get( data, offset );
+  size_t length = prefix + middle + suffix;
+  size_t old    = tail.size( );
+
+  if ( length > old ) {
+    tail.resize( length );
+  }
+  if ( suffix != 0 ) {
+    memmove( &tail[ prefix + middle ], &tail[ old - suffix ], suffix );
+  }
+  if ( middle != 0 ) {
+    memcpy( &tail[ prefix ], data.data( ) + offset, middle );
+  }
+  tail.resize( length );
+  offset += middle;
+}
+
+/**
+ * @brief Split a URI into its group key (scheme and authority) and the rest
+ * @param uri URI string
+ * @return key length
+ */
+static size_t uriset_split( const std::string &uri ) {
+  UriView view;
+
+  UriView::parse( uri, view );
+  return view.prefix( ).size;
+}
+
+/**
+ * @brief Build the set; the builder is left empty
+ * @return compressed set
+ */
+UriSet UriSet::Builder::build( ) {
+  std::vector< std::pair< std::string, std::string > > entries;
+  UriSet                                               set;
+
+  entries.reserve( uris.size( ) );
+  for ( auto &uri : uris ) {
+    size_t split = uriset_split( uri );
+    entries.emplace_back( uri.substr( 0, split ), uri.substr( split ) );
+  }
+  std::vector< std::string >( ).swap( uris );
+
+  std::sort( entries.begin( ), entries.end( ) );
+  entries.erase( std::unique( entries.begin( ), entries.end( ) ), entries.end( ) );
+
+  set.keyOffsets.clear( );
+  set.groupStart.clear( );
+  set.groupBlock.clear( );
+
+  const std::string *previous = nullptr;
+  size_t             index    = 0;
+
+  for ( size_t entry = 0; entry < entries.size( ); ++entry ) {
+    const std::string &key  = entries[ entry ].first;
+    const std::string &tail = entries[ entry ].second;
+
+    if ( ( entry == 0 ) || ( key != entries[ entry - 1 ].first ) ) {
+      set.keyOffsets.push_back( static_cast< uint32_t >( set.keys.size( ) ) );
+      set.groupStart.push_back( static_cast< uint32_t >( entry ) );
+      set.groupBlock.push_back( static_cast< uint32_t >( set.blocks.size( ) ) );
+      set.keys.append( key );
+      index = 0;
+    }
+
+    if ( index++ % BLOCK == 0 ) {
+      set.blocks.push_back( set.data.size( ) );
+      uriset_put( set.data, tail.size( ) );
+      set.data.append( tail );
+    } else {
+      size_t prefix = 0;
+      size_t suffix = 0;
+      size_t limit  = std::min( tail.size( ), previous->size( ) );
+
+      while ( ( prefix < limit ) && ( tail[ prefix ] == ( *previous )[ prefix ] ) ) {
+        ++prefix;
+      }
+      while ( ( prefix + suffix < limit ) &&
+              ( tail[ tail.size( ) - suffix - 1 ] ==
+                ( *previous )[ previous->size( ) - suffix - 1 ] ) ) {
+        ++suffix;
+      }
+
+      uriset_put( set.data, prefix );
+      uriset_put( set.data, suffix );
+      uriset_put( set.data, tail.size( ) - prefix - suffix );
+      set.data.append( tail, prefix, tail.size( ) - prefix - suffix );
+    }
+
+    previous = &tail;
+  }
+
+  set.keyOffsets.push_back( static_cast< uint32_t >( set.keys.size( ) ) );
+  set.groupStart.push_back( static_cast< uint32_t >( entries.size( ) ) );
+  set.groupBlock.push_back( static_cast< uint32_t >( set.blocks.size( ) ) );
+
+  set.keys.shrink_to_fit( );
+  set.data.shrink_to_fit( );
+  set.keyOffsets.shrink_to_fit( );
+  set.groupStart.shrink_to_fit( );
+  set.groupBlock.shrink_to_fit( );
+  set.blocks.shrink_to_fit( );
+
+  return set;
+}
+
+UriSet::UriSet( )
+  : keyOffsets( 1, 0 )
+  , groupStart( 1, 0 )
+  , groupBlock( 1, 0 ) {}
+
+/**
+ * @brief Get a group key
+ * @param group group index
+ * @return scheme and authority shared by the group
+ */
+std::string UriSet::key( size_t group ) const {
+  return keys.substr( keyOffsets[ group ], keyOffsets[ group + 1 ] - keyOffsets[ group ] );
+}
+
+/**
+ * @brief Compare a group key
+ * @param group group index
+ * @param key key to compare with
+ * @return <0, 0 or >0 as the group key sorts before, equal to or after @p key
+ */
+int UriSet::keyCompare( size_t group, const std::string &key ) const {
+  return keys.compare( keyOffsets[ group ], keyOffsets[ group + 1 ] - keyOffsets[ group ], key );
+}
+
+/**
+ * @brief Find the first group whose key is not less than @p key
+ * @param key group key
+ * @return group index, groups() if none
+ */
+size_t UriSet::findGroup( const std::string &key ) const {
+  size_t low  = 0;
+  size_t high = groups( );
+
+  while ( low < high ) {
+    size_t middle = ( low + high ) / 2;
+
+    if ( keyCompare( middle, key ) < 0 ) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/**
+ * @brief Find the last block of a group whose head is not greater than @p tail
+ * @param group group index
+ * @param tail URI remainder after the group key
+ * @return block index (the group's first block if every head is greater)
+ */
+size_t UriSet::findBlock( size_t group, const std::string &tail ) const {
+  size_t low  = groupBlock[ group ];
+  size_t high = groupBlock[ group + 1 ];
+
+  while ( high - low > 1 ) {
+    size_t middle = ( low + high ) / 2;
+    size_t offset = blocks[ middle ];
+    size_t length = uriset_get( data, offset );
+
+    if ( data.compare( offset, length, tail ) <= 0 ) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/**
+ * @brief Check for a URI
+ * @param uri URI string
+ * @return true if the set holds the URI
+ */
+bool UriSet::contains( const std::string &uri ) const {
+  size_t      split = uriset_split( uri );
+  std::string key   = uri.substr( 0, split );
+  std::string tail  = uri.substr( split );
+  size_t      group = findGroup( key );
+
+  if ( ( group == groups( ) ) || keyCompare( group, key ) ) {
+    return false;
+  }
+
+  size_t      block  = findBlock( group, tail );
+  size_t      offset = blocks[ block ];
+  size_t      first  = groupStart[ group ] + ( block - groupBlock[ group ] ) * BLOCK;
+  size_t      last   = std::min< size_t >( first + BLOCK, groupStart[ group + 1 ] );
+  std::string entry;
+
+  for ( size_t index = first; index < last; ++index ) {
+    uriset_decode( data, offset, index == first, entry );
+
+    int order = entry.compare( tail );
+    if ( order >= 0 ) {
+      return order == 0;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Visit the URIs of a group whose remainder starts with @p tail
+ * @param group group index
+ * @param tail remainder prefix
+ * @param callback visitor
+ * @param stop set when the callback stops the scan
+ * @return number of URIs visited
+ */
+size_t UriSet::visit( size_t                                              group,
+                      const std::string &                                 tail,
+                      const std::function< bool( const std::string & ) > &callback,
+                      bool &                                              stop ) const {
+  size_t      block  = findBlock( group, tail );
+  size_t      offset = blocks[ block ];
+  size_t      first  = groupStart[ group ] + ( block - groupBlock[ group ] ) * BLOCK;
+  size_t      count  = 0;
+  std::string prefix = key( group );
+  std::string entry;
+  std::string uri;
+
+  for ( size_t index = first; index < groupStart[ group + 1 ]; ++index ) {
+    uriset_decode( data, offset, ( index - groupStart[ group ] ) % BLOCK == 0, entry );
+
+    if ( entry.compare( 0, tail.size( ), tail ) == 0 ) {
+      uri.assign( prefix ).append( entry );
+      ++count;
+      if ( !callback( uri ) ) {
+        stop = true;
+        break;
+      }
+    } else if ( entry > tail ) {
+      break;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief Visit every URI that starts with a prefix
+ * @param prefix URI prefix
+ * @param callback invoked with each URI; return false to stop
+ * @return number of URIs visited
+ */
+size_t UriSet::scan( const std::string &                                 prefix,
+                     const std::function< bool( const std::string & ) > &callback ) const {
+  size_t count = 0;
+  bool   stop  = false;
+  size_t split = uriset_split( prefix );
+
+  /* The group the prefix itself belongs to, when the prefix reaches past its key */
+  if ( split < prefix.size( ) ) {
+    std::string key   = prefix.substr( 0, split );
+    size_t      group = findGroup( key );
+
+    if ( ( group < groups( ) ) && !keyCompare( group, key ) ) {
+      count += visit( group, prefix.substr( split ), callback, stop );
+    }
+  }
+
+  /* Every group whose key starts with the prefix */
+  for ( size_t group = findGroup( prefix ); !stop && ( group < groups( ) ); ++group ) {
+    if ( keys.compare( keyOffsets[ group ],
+                       std::min< size_t >( prefix.size( ),
+                                           keyOffsets[ group + 1 ] - keyOffsets[ group ] ),
+                       prefix ) ) {
+      break;
+    }
+    count += visit( group, std::string( ), callback, stop );
+  }
+
+  return count;
+}
+
+/**
+ * @brief Get the memory held by the set
+ * @return bytes
+ */
+size_t UriSet::memory( ) const {
+  return sizeof( *this ) + keys.capacity( ) + data.capacity( ) +
+         ( keyOffsets.capacity( ) + groupStart.capacity( ) + groupBlock.capacity( ) ) *
+           sizeof( uint32_t ) +
+         blocks.capacity( ) * sizeof( uint64_t );
+}
+
+UriSet::const_iterator::const_iterator( const UriSet *set, size_t group, size_t entry )
+  : set( set )
+  , group( group )
+  , entry( entry )
+  , offset( 0 ) {
+  if ( entry < set->size( ) ) {
+    load( );
+  }
+}
+
+/**
+ * @brief Decode the entry at the current position
+ */
+void UriSet::const_iterator::load( ) {
+  uriset_decode( set->data, offset, ( entry - set->groupStart[ group ] ) % BLOCK == 0, tail );
+  current.assign( set->keys, set->keyOffsets[ group ],
+                  set->keyOffsets[ group + 1 ] - set->keyOffsets[ group ] );
+  current.append( tail );
+}
+
+UriSet::const_iterator &UriSet::const_iterator::operator++( ) {
+  if ( ++entry >= set->size( ) ) {
+    entry = set->size( );
+    current.clear( );
+    return *this;
+  }
+
+  if ( entry == set->groupStart[ group + 1 ] ) {
+    ++group;
+  }
+  load( );
+  return *this;
+}
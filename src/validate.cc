@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uri/uri.hh"
+#include "uri/view.hh"
+#include "charclass.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+/**
+ * Characters allowed (besides percent escapes) in each component, RFC 3986 section 3
+ */
+enum ValidateKind {
+  VALIDATE_USERINFO,
+  VALIDATE_HOST,
+  VALIDATE_PATH,
+  VALIDATE_QUERY,
+  VALIDATE_KINDS
+};
+
+static const char *const VALIDATE_NAMES[ VALIDATE_KINDS ] = { "user info", "host", "path",
+                                                              "query" };
+
+/**
+ * @brief Build the per component character tables
+ * @return tables indexed by ValidateKind, then by byte value
+ */
+static const bool ( *validate_tables( ) )[ 256 ] {
+  static const struct Tables {
+    bool allowed[ VALIDATE_KINDS ][ 256 ];
+
+    Tables( ) {
+      memset( allowed, 0, sizeof( allowed ) );
+
+      for ( int ch = 0; ch < 256; ++ch ) {
+        bool common =
+          uri_is( static_cast< unsigned char >( ch ), URI_CC_UNRESERVED | URI_CC_SUB_DELIM );
+
+        bool path = common || ( ch == ':' ) || ( ch == '@' ) || ( ch == '/' );
+
+        allowed[ VALIDATE_USERINFO ][ ch ] = common || ( ch == ':' );
+        allowed[ VALIDATE_HOST ][ ch ]     = common;
+        allowed[ VALIDATE_PATH ][ ch ]     = path;
+        allowed[ VALIDATE_QUERY ][ ch ]    = path || ( ch == '?' );
+      }
+    }
+  } tables;
+
+  return tables.allowed;
+}
+
+/**
+ * UTF-8 well-formedness of the percent-decoded bytes (RFC 3629 section 4)
+ */
+struct Utf8State {
+  int     remaining = 0;    ///< continuation bytes still expected
+  uint8_t lower     = 0x80; ///< bounds of the next continuation byte
+  uint8_t upper     = 0xBF;
+
+  bool octet( uint8_t byte ) {
+    if ( remaining != 0 ) {
+      if ( ( byte < lower ) || ( byte > upper ) ) {
+        return false;
+      }
+      lower = 0x80;
+      upper = 0xBF;
+      --remaining;
+      return true;
+    }
+
+    if ( byte < 0x80 ) {
+      return true;
+    } else if ( ( byte >= 0xC2 ) && ( byte <= 0xDF ) ) {
+      remaining = 1;
+    } else if ( ( byte >= 0xE0 ) && ( byte <= 0xEF ) ) {
+      remaining = 2;
+      lower     = ( byte == 0xE0 ) ? 0xA0 : 0x80;
+      upper     = ( byte == 0xED ) ? 0x9F : 0xBF;
+    } else if ( ( byte >= 0xF0 ) && ( byte <= 0xF4 ) ) {
+      remaining = 3;
+      lower     = ( byte == 0xF0 ) ? 0x90 : 0x80;
+      upper     = ( byte == 0xF4 ) ? 0x8F : 0xBF;
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
+#if defined( __SSE2__ )
+/**
+ * @brief Classify 16 bytes as plain (ALPHA / DIGIT / "-" / "." / "_" / "~" / "/")
+ * @param data 16 input bytes
+ * @return true if every byte is plain; those bytes are valid in every checked component but host
+ */
+static bool validate_plain( const char *data ) {
+  __m128i chunk = _mm_loadu_si128( reinterpret_cast< const __m128i * >( data ) );
+  __m128i lower = _mm_or_si128( chunk, _mm_set1_epi8( 0x20 ) );
+  __m128i alpha = _mm_and_si128( _mm_cmpgt_epi8( lower, _mm_set1_epi8( 'a' - 1 ) ),
+                                 _mm_cmplt_epi8( lower, _mm_set1_epi8( 'z' + 1 ) ) );
+  __m128i digit = _mm_and_si128( _mm_cmpgt_epi8( chunk, _mm_set1_epi8( '0' - 1 ) ),
+                                 _mm_cmplt_epi8( chunk, _mm_set1_epi8( '9' + 1 ) ) );
+  __m128i marks = _mm_or_si128(
+    _mm_or_si128( _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '-' ) ),
+                  _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '.' ) ) ),
+    _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '_' ) ),
+                                _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '~' ) ) ),
+                  _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '/' ) ) ) );
+
+  return _mm_movemask_epi8( _mm_or_si128( _mm_or_si128( alpha, digit ), marks ) ) == 0xFFFF;
+}
+#endif
+
+/**
+ * @brief Validate one component
+ * @param span component bytes
+ * @param kind component character set
+ * @param failure set to the offending position on failure
+ * @return true if valid
+ */
+static bool validate_component( const UriView::Span &span,
+                                ValidateKind         kind,
+                                const char *&        failure ) {
+  const bool *allowed = validate_tables( )[ kind ];
+  const char *pos     = span.begin( );
+  const char *end     = span.end( );
+  Utf8State   utf8;
+
+  while ( pos != end ) {
+#if defined( __SSE2__ )
+    /* '/' is plain, so the host (which excludes it) always takes the byte path */
+    if ( ( kind != VALIDATE_HOST ) && ( utf8.remaining == 0 ) ) {
+      while ( ( end - pos >= 16 ) && validate_plain( pos ) ) {
+        pos += 16;
+      }
+      if ( pos == end ) {
+        break;
+      }
+    }
+#endif
+    unsigned char ch = static_cast< unsigned char >( *pos );
+
+    if ( ch == '%' ) {
+      if ( !uri_is_pct_triplet( pos, end - pos ) ||
+           !utf8.octet( ( uri_hex_value( pos[ 1 ] ) << 4 ) | uri_hex_value( pos[ 2 ] ) ) ) {
+        failure = pos;
+        return false;
+      }
+      pos += 3;
+      continue;
+    }
+
+    if ( !allowed[ ch ] || ( utf8.remaining != 0 ) ) {
+      failure = pos;
+      return false;
+    }
+    ++pos;
+  }
+
+  if ( utf8.remaining != 0 ) {
+    failure = end;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Validate a dotted decimal IPv4 address (RFC 3986 section 3.2.2, IPv4address)
+ * @param pos first character
+ * @param end end of the address
+ * @return true if valid
+ */
+static bool validate_ipv4( const char *pos, const char *end ) {
+  for ( int octet = 0; octet < 4; ++octet ) {
+    if ( octet > 0 ) {
+      if ( ( pos == end ) || ( *pos != '.' ) ) {
+        return false;
+      }
+      ++pos;
+    }
+
+    const char *start = pos;
+    int         value = 0;
+
+    while ( ( pos != end ) && ( pos - start < 3 ) &&
+            uri_is( static_cast< unsigned char >( *pos ), URI_CC_DIGIT ) ) {
+      value = value * 10 + ( *pos++ - '0' );
+    }
+
+    /* dec-octet: 0 to 255 without leading zeros */
+    if ( ( pos == start ) || ( ( pos - start > 1 ) && ( *start == '0' ) ) || ( value > 255 ) ) {
+      return false;
+    }
+  }
+  return pos == end;
+}
+
+/**
+ * @brief Validate an IPv6 address (RFC 3986 section 3.2.2, IPv6address)
+ *
+ * Eight 16 bit pieces of one to four hex digits, the last two of which may be written as an
+ * IPv4 address; one run of pieces may be elided with "::".
+ *
+ * @param pos first character
+ * @param end end of the address
+ * @return true if valid
+ */
+static bool validate_ipv6( const char *pos, const char *end ) {
+  int  pieces     = 0;
+  bool compressed = false;
+
+  if ( ( end - pos >= 2 ) && ( pos[ 0 ] == ':' ) && ( pos[ 1 ] == ':' ) ) {
+    compressed = true;
+    pos += 2;
+  }
+
+  while ( pos != end ) {
+    const char *start = pos;
+
+    while ( ( pos != end ) && uri_is( static_cast< unsigned char >( *pos ), URI_CC_HEXDIG ) ) {
+      ++pos;
+    }
+
+    if ( ( pos != end ) && ( *pos == '.' ) ) {
+      /* ls32 written as an IPv4 address ends the address */
+      if ( ( pieces > 6 ) || !validate_ipv4( start, end ) ) {
+        return false;
+      }
+      pieces += 2;
+      break;
+    }
+
+    if ( ( pos == start ) || ( pos - start > 4 ) ) {
+      return false;
+    }
+    ++pieces;
+
+    if ( pos == end ) {
+      break;
+    }
+    if ( ( *pos != ':' ) || ( ++pos == end ) ) {
+      return false;
+    }
+    if ( *pos == ':' ) {
+      if ( compressed ) {
+        return false;
+      }
+      compressed = true;
+      ++pos;
+    }
+  }
+
+  return compressed ? ( pieces <= 7 ) : ( pieces == 8 );
+}
+
+/**
+ * @brief Validate an IPvFuture address ("v" 1*HEXDIG "." 1*( unreserved / sub-delims / ":" ))
+ * @param pos first character
+ * @param end end of the address
+ * @return true if valid
+ */
+static bool validate_ipvfuture( const char *pos, const char *end ) {
+  if ( ( pos == end ) || ( ( *pos != 'v' ) && ( *pos != 'V' ) ) ) {
+    return false;
+  }
+
+  const char *version = ++pos;
+
+  while ( ( pos != end ) && uri_is( static_cast< unsigned char >( *pos ), URI_CC_HEXDIG ) ) {
+    ++pos;
+  }
+  if ( ( pos == version ) || ( pos == end ) || ( *pos != '.' ) || ( ++pos == end ) ) {
+    return false;
+  }
+
+  for ( ; pos != end; ++pos ) {
+    unsigned char ch = static_cast< unsigned char >( *pos );
+
+    if ( !uri_is( ch, URI_CC_UNRESERVED | URI_CC_SUB_DELIM ) && ( ch != ':' ) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Validate an IP literal host ("[" IPv6address / IPvFuture "]")
+ * @param span host bytes, including the brackets
+ * @param failure set to the offending position on failure
+ * @return true if valid
+ */
+static bool validate_ip_literal( const UriView::Span &span, const char *&failure ) {
+  if ( ( span.size < 3 ) || ( span.data[ span.size - 1 ] != ']' ) ) {
+    failure = span.end( );
+    return false;
+  }
+
+  const char *begin = span.begin( ) + 1;
+  const char *end   = span.end( ) - 1;
+
+  if ( !validate_ipv6( begin, end ) && !validate_ipvfuture( begin, end ) ) {
+    failure = begin;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Reject relative references whose first segment contains a ':' (path-noscheme)
+ * @param view split URI
+ * @param failure set to the offending position on failure
+ * @return true if valid
+ */
+static bool validate_relative( const UriView &view, const char *&failure ) {
+  if ( view.scheme.present( ) || view.authority.present( ) ) {
+    return true;
+  }
+
+  const char *segment = std::find( view.resource.begin( ), view.resource.end( ), '/' );
+  const char *colon   = std::find( view.resource.begin( ), segment, ':' );
+
+  if ( colon != segment ) {
+    failure = colon;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Strictly validate a URI against RFC 3986
+ *
+ * Every component is checked against its character set, every percent escape must be
+ * complete, and the percent-decoded bytes of each component must be well-formed UTF-8.
+ * Runs of plain characters are skipped 16 bytes at a time when built with SSE2.
+ *
+ * @param uri URI string
+ * @param reason set to a description of the first problem found, if not null
+ * @return true if valid
+ */
+bool Uri::validate( const std::string &uri, std::string *reason ) {
+  UriView     view;
+  const char *failure = nullptr;
+  const char *where   = nullptr;
+
+  if ( !UriView::parse( uri, view ) ) {
+    failure = view.port.begin( );
+    where   = "port";
+  } else if ( !validate_relative( view, failure ) ) {
+    where = "scheme";
+  } else if ( !validate_component( view.user, VALIDATE_USERINFO, failure ) ||
+              !validate_component( view.password, VALIDATE_USERINFO, failure ) ) {
+    where = VALIDATE_NAMES[ VALIDATE_USERINFO ];
+  } else if ( ( ( view.host.size != 0 ) && ( view.host.data[ 0 ] == '[' ) )
+                ? !validate_ip_literal( view.host, failure )
+                : !validate_component( view.host, VALIDATE_HOST, failure ) ) {
+    where = VALIDATE_NAMES[ VALIDATE_HOST ];
+  } else if ( !validate_component( view.resource, VALIDATE_PATH, failure ) ) {
+    where = VALIDATE_NAMES[ VALIDATE_PATH ];
+  } else if ( !validate_component( view.query, VALIDATE_QUERY, failure ) ) {
+    where = VALIDATE_NAMES[ VALIDATE_QUERY ];
+  } else if ( !validate_component( view.fragment, VALIDATE_QUERY, failure ) ) {
+    where = "fragment";
+  } else {
+    return true;
+  }
+
+  if ( reason != nullptr ) {
+    *reason = std::string( "invalid " ) + where + " at offset " +
+              std::to_string( failure - uri.data( ) );
+  }
+  return false;
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uri/view.hh"
+#include "charclass.hh"
+
+/**
+ * @brief Split the authority section into its components
+ * @param view destination view (authority already set)
+ * @return true on success, false if the port is malformed
+ */
+static bool view_authority( UriView &view ) {
+  const char *begin = view.authority.begin( );
+  const char *end   = view.authority.end( );
+  const char *host  = begin;
+
+  for ( const char *at = end; at != begin; --at ) {
+    if ( at[ -1 ] == '@' ) {
+      const char *colon = static_cast< const char * >( memchr( begin, ':', at - 1 - begin ) );
+
+      if ( colon != nullptr ) {
+        view.user     = UriView::Span( begin, colon - begin );
+        view.password = UriView::Span( colon + 1, at - 1 - colon - 1 );
+      } else {
+        view.user = UriView::Span( begin, at - 1 - begin );
+      }
+      host = at;
+      break;
+    }
+  }
+
+  const char *port = end;
+
+  if ( ( host != end ) && ( *host == '[' ) ) {
+    const char *close = static_cast< const char * >( memchr( host, ']', end - host ) );
+
+    if ( ( close != nullptr ) && ( close + 1 != end ) && ( close[ 1 ] == ':' ) ) {
+      port = close + 1;
+    }
+  } else {
+    for ( const char *pos = end; pos != host; --pos ) {
+      if ( pos[ -1 ] == ':' ) {
+        port = pos - 1;
+        break;
+      }
+    }
+  }
+
+  view.host = UriView::Span( host, port - host );
+
+  if ( port != end ) {
+    view.port = UriView::Span( port + 1, end - port - 1 );
+
+    for ( const char *ch = view.port.begin( ); ch != view.port.end( ); ++ch ) {
+      if ( !uri_is( static_cast< unsigned char >( *ch ), URI_CC_DIGIT ) ) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Split a URI string into its components
+ * @param data URI string
+ * @param size URI length
+ * @param view destination view
+ * @return true on success, false if the authority has a malformed port
+ */
+bool UriView::parse( const char *data, size_t size, UriView &view ) {
+  const char *pos = data;
+  const char *end = data + size;
+  bool        ok  = true;
+
+  view     = UriView( );
+  view.uri = Span( data, size );
+
+  /* scheme = ALPHA *( ALPHA / DIGIT / "+" / "-" / "." ) ":" */
+  if ( ( pos != end ) && uri_is( static_cast< unsigned char >( *pos ), URI_CC_ALPHA ) ) {
+    const char *scan = pos + 1;
+
+    while ( ( scan != end ) &&
+            ( uri_is( static_cast< unsigned char >( *scan ), URI_CC_ALPHA | URI_CC_DIGIT ) ||
+              ( *scan == '+' ) || ( *scan == '-' ) || ( *scan == '.' ) ) ) {
+      ++scan;
+    }
+
+    if ( ( scan != end ) && ( *scan == ':' ) ) {
+      view.scheme = Span( pos, scan - pos );
+      pos         = scan + 1;
+    }
+  }
+
+  if ( ( end - pos >= 2 ) && ( pos[ 0 ] == '/' ) && ( pos[ 1 ] == '/' ) ) {
+    const char *authority = pos + 2;
+
+    pos = authority;
+    while ( ( pos != end ) && ( *pos != '/' ) && ( *pos != '?' ) && ( *pos != '#' ) ) {
+      ++pos;
+    }
+
+    view.authority = Span( authority, pos - authority );
+    ok             = view_authority( view );
+  }
+
+  const char *resource = pos;
+
+  while ( ( pos != end ) && ( *pos != '?' ) && ( *pos != '#' ) ) {
+    ++pos;
+  }
+  view.resource = Span( resource, pos - resource );
+
+  if ( ( pos != end ) && ( *pos == '?' ) ) {
+    const char *query = ++pos;
+
+    while ( ( pos != end ) && ( *pos != '#' ) ) {
+      ++pos;
+    }
+    view.query = Span( query, pos - query );
+  }
+
+  if ( ( pos != end ) && ( *pos == '#' ) ) {
+    ++pos;
+    view.fragment = Span( pos, end - pos );
+  }
+
+  return ok;
+}
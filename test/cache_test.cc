@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#undef NDEBUG
+#include "uri/cache.hh"
+#include <assert.h>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main( int argc, char *argv[] ) {
+  UriCache cache( 4, 1 );
+
+  auto first  = cache.get( "http://www.google.com/?q=a" );
+  auto second = cache.get( "http://www.google.com/?q=a" );
+
+  assert( first == second );
+  assert( first->host( ) == "www.google.com" );
+  assert( first->getQuery( "q" ).front( ) == "a" );
+
+  UriCache::Statistics statistics = cache.statistics( );
+  assert( statistics.hits == 1 );
+  assert( statistics.misses == 1 );
+  assert( statistics.entries == 1 );
+
+  /* Copies are independent of the cached entry */
+  std::unique_ptr< Uri > copy( cache.parse( "http://www.google.com/?q=a" ) );
+  copy->host( "example.com" );
+  copy->addQuery( std::string( "r" ), std::string( "b" ) );
+  assert( copy->toString( ) == "http://example.com/?q=a&r=b" );
+  assert( cache.get( "http://www.google.com/?q=a" )->host( ) == "www.google.com" );
+
+  /* Prefix entries are shared by every URI of the same origin */
+  auto origin = cache.prefix( "https://user@api.example.com:8443/v1/a?x=1" );
+  assert( origin == cache.prefix( "https://user@api.example.com:8443/v2/b" ) );
+  assert( origin->host( ) == "api.example.com" );
+  assert( origin->port( ) == 8443 );
+  assert( origin->user( ) == "user" );
+
+  /* CLOCK eviction keeps the capacity bound and favours referenced entries */
+  cache.clear( );
+  cache.get( "http://a/" );
+  cache.get( "http://b/" );
+  cache.get( "http://c/" );
+  cache.get( "http://d/" );
+  cache.get( "http://a/" );
+  cache.get( "http://e/" );
+
+  statistics = cache.statistics( );
+  assert( statistics.entries == 4 );
+  assert( statistics.evictions == 1 );
+
+  uint64_t hits = statistics.hits;
+  cache.get( "http://a/" );
+  assert( cache.statistics( ).hits == hits + 1 );
+
+  /* Concurrent use */
+  UriCache                   shared( 256, 8 );
+  std::vector< std::thread > threads;
+
+  for ( int thread = 0; thread < 4; ++thread ) {
+    threads.emplace_back( [&shared]( ) {
+      for ( int index = 0; index < 2000; ++index ) {
+        auto uri = shared.get( "http://host" + std::to_string( index % 300 ) + ".com/" );
+        assert( uri->host( ) == "host" + std::to_string( index % 300 ) + ".com" );
+      }
+    } );
+  }
+  for ( auto &thread : threads ) {
+    thread.join( );
+  }
+
+  statistics = shared.statistics( );
+  assert( statistics.hits + statistics.misses == 8000 );
+  assert( statistics.entries <= 256 );
+
+  /* Workers modify their own copies of one shared entry concurrently */
+  auto entry = shared.get( "http://www.example.com/path?q=a" );
+  threads.clear( );
+
+  for ( int thread = 0; thread < 4; ++thread ) {
+    threads.emplace_back( [&entry, thread]( ) {
+      for ( int index = 0; index < 500; ++index ) {
+        std::unique_ptr< Uri > stage( entry->clone( ) );
+        std::unique_ptr< Uri > next( stage->clone( ) );
+        std::string            value = std::to_string( thread ) + "-" + std::to_string( index );
+
+        next->addQuery( std::string( "w" ), value );
+        assert( next->toString( ) == "http://www.example.com/path?q=a&w=" + value );
+        assert( stage->toString( ) == "http://www.example.com/path?q=a" );
+      }
+    } );
+  }
+  for ( auto &thread : threads ) {
+    thread.join( );
+  }
+  assert( entry->getQuery( "w" ).empty( ) );
+
+  return 0;
+}
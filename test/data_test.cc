@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#undef NDEBUG
+#include "uri/data.hh"
+#include <assert.h>
+#include <iostream>
+#include <stdexcept>
+
+static std::string encode( const std::string &value ) {
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string       out;
+
+  for ( size_t index = 0; index < value.size( ); index += 3 ) {
+    uint32_t quantum = static_cast< unsigned char >( value[ index ] ) << 16;
+    size_t   left    = value.size( ) - index;
+
+    if ( left > 1 ) {
+      quantum |= static_cast< unsigned char >( value[ index + 1 ] ) << 8;
+    }
+    if ( left > 2 ) {
+      quantum |= static_cast< unsigned char >( value[ index + 2 ] );
+    }
+
+    out += alphabet[ ( quantum >> 18 ) & 0x3F ];
+    out += alphabet[ ( quantum >> 12 ) & 0x3F ];
+    out += ( left > 1 ) ? alphabet[ ( quantum >> 6 ) & 0x3F ] : '=';
+    out += ( left > 2 ) ? alphabet[ quantum & 0x3F ] : '=';
+  }
+  return out;
+}
+
+int main( int argc, char *argv[] ) {
+  DataUri     uri;
+  std::string text = "data:,A%20brief%20note";
+
+  assert( DataUri::parse( text, uri ) );
+  assert( uri.mediaType( ) == "text/plain" );
+  assert( !uri.base64( ) );
+  assert( uri.payload( ) == "A%20brief%20note" );
+  assert( uri.payload( ).data == text.data( ) + 6 );
+  assert( uri.decode( ) == "A brief note" );
+
+  std::string typed = "data:text/plain;charset=iso-8859-7;foo,%be%d3%be";
+  assert( DataUri::parse( typed, uri ) );
+  assert( uri.mediaType( ) == "text/plain" );
+  assert( uri.parameters( ).size( ) == 2 );
+  assert( uri.parameter( "CHARSET" ) == "iso-8859-7" );
+  assert( uri.parameter( "foo" ).present( ) );
+  assert( !uri.parameter( "bar" ).present( ) );
+  assert( uri.decode( ) == "\xbe\xd3\xbe" );
+
+  std::string image = "data:image/png;base64,iVBORw0KGgo=#frag";
+  assert( DataUri::parse( image, uri ) );
+  assert( uri.mediaType( ) == "image/png" );
+  assert( uri.base64( ) );
+  assert( uri.payload( ) == "iVBORw0KGgo=" );
+  assert( uri.decode( ) == std::string( "\x89PNG\r\n\x1a\n", 8 ) );
+
+  std::string plain = "http://example.com/";
+  assert( !DataUri::parse( plain, uri ) );
+
+  /* Every length and alignment, through the block and quantum paths */
+  std::string binary;
+  for ( int index = 0; index < 1000; ++index ) {
+    binary += static_cast< char >( ( index * 131 + 7 ) & 0xFF );
+  }
+
+  for ( size_t length = 0; length < 200; ++length ) {
+    std::string payload = "data:application/octet-stream;base64," +
+                          encode( binary.substr( 0, length ) );
+    assert( DataUri::parse( payload, uri ) );
+    assert( uri.decode( ) == binary.substr( 0, length ) );
+  }
+
+  std::string large = encode( binary );
+  std::string out( large.size( ), '\0' );
+  assert( DataUri::decodeBase64( large.data( ), large.size( ), &out[ 0 ] ) == binary.size( ) );
+  assert( out.substr( 0, binary.size( ) ) == binary );
+
+  /* Whitespace, missing padding and malformed input */
+  std::string wrapped = encode( binary.substr( 0, 100 ) );
+  wrapped.insert( 76, "\r\n" );
+  wrapped.insert( 20, " " );
+  assert( DataUri::decodeBase64( wrapped.data( ), wrapped.size( ), &out[ 0 ] ) == 100 );
+  assert( out.substr( 0, 100 ) == binary.substr( 0, 100 ) );
+  assert( DataUri::decodeBase64( "QQ", 2, &out[ 0 ] ) == 1 && out[ 0 ] == 'A' );
+  assert( DataUri::decodeBase64( "QUJDRA", 6, &out[ 0 ] ) == 4 );
+  assert( DataUri::decodeBase64( "Q", 1, &out[ 0 ] ) == DataUri::INVALID );
+  assert( DataUri::decodeBase64( "QQ==QQ==", 8, &out[ 0 ] ) == DataUri::INVALID );
+  assert( DataUri::decodeBase64( "AAAAAAAAAAAAAAA*AAAA", 20, &out[ 0 ] ) == DataUri::INVALID );
+
+  std::string broken = "data:;base64,@@@@";
+  assert( DataUri::parse( broken, uri ) );
+  assert( uri.decode( &out[ 0 ], 1 ) == DataUri::INVALID );
+
+  bool thrown = false;
+  try {
+    uri.decode( );
+  } catch ( std::runtime_error &ex ) {
+    thrown = true;
+  }
+  assert( thrown );
+
+  return 0;
+}
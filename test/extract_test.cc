@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#undef NDEBUG
+#include "uri/extract.hh"
+#include <assert.h>
+#include <iostream>
+#include <memory>
+
+static std::vector< std::string > extracted( const std::string &text ) {
+  std::vector< std::string > uris;
+
+  for ( auto &match : UriExtractor::extract( text ) ) {
+    assert( text.substr( match.offset, match.length ) == match.view.uri.str( ) );
+    uris.push_back( match.view.uri.str( ) );
+  }
+  return uris;
+}
+
+int main( int argc, char *argv[] ) {
+  typedef std::vector< std::string > Uris;
+
+  assert( extracted( "see http://www.example.com/a?b=c#d." ) ==
+          ( Uris{ "http://www.example.com/a?b=c#d" } ) );
+  assert( extracted( "(https://en.wikipedia.org/wiki/Foo_(bar)), and more" ) ==
+          ( Uris{ "https://en.wikipedia.org/wiki/Foo_(bar)" } ) );
+  assert( extracted( "Visit www.example.org/path, or WWW.Example.net!" ) ==
+          ( Uris{ "www.example.org/path", "WWW.Example.net" } ) );
+  assert( extracted( "mail mailto:jerk@wad.com or call tel:+18008080085;" ) ==
+          ( Uris{ "mailto:jerk@wad.com", "tel:+18008080085" } ) );
+  assert( extracted( "Note: nothing here, time 10:30, ratio a:b, http:// alone" ).empty( ) );
+  assert( extracted( "<a href=\"http://a.b/c\">x</a>" ) == ( Uris{ "http://a.b/c" } ) );
+  assert( extracted( "ftp://[::1]:21/x]" ) == ( Uris{ "ftp://[::1]:21/x" } ) );
+  assert( extracted( "http://a.com/x,http://b.com/y" ) ==
+          ( Uris{ "http://a.com/x,http://b.com/y" } ) );
+  assert( extracted( "awww.example.com" ).empty( ) );
+
+  /* Long text exercises the vectorized anchor scan */
+  std::string text;
+  for ( int index = 0; index < 1000; ++index ) {
+    text += "lorem ipsum dolor sit amet, consectetur adipiscing elit https://h" +
+            std::to_string( index ) + ".example.com/p?i=" + std::to_string( index ) + " ";
+  }
+
+  auto matches = UriExtractor::extract( text );
+  assert( matches.size( ) == 1000 );
+  assert( matches[ 7 ].view.host == "h7.example.com" );
+  assert( matches[ 7 ].view.query == "i=7" );
+
+  size_t count = UriExtractor::extract( text.data( ), text.size( ),
+                                        []( const UriExtractor::Match & ) { return false; } );
+  assert( count == 1 );
+
+  auto uri = std::shared_ptr< Uri >( matches[ 0 ].parse( ) );
+  assert( uri->host( ) == "h0.example.com" );
+
+  std::string www = "at www.example.org/path.";
+  auto        web = std::shared_ptr< Uri >( UriExtractor::extract( www )[ 0 ].parse( ) );
+  assert( web->scheme( ) == "http" );
+  assert( web->host( ) == "www.example.org" );
+  assert( web->resource( ) == "/path" );
+
+  return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#undef NDEBUG
+#include "uri/filter.hh"
+#include <assert.h>
+#include <iostream>
+
+static std::string filtered( const QueryFilter &filter, std::string uri ) {
+  filter.apply( uri );
+  return uri;
+}
+
+int main( int argc, char *argv[] ) {
+  QueryFilter tracking;
+
+  tracking.prefix( "utm_" ).key( "fbclid" ).key( "gclid" );
+
+  assert( tracking.matches( "utm_source", 10 ) );
+  assert( tracking.matches( "utm_", 4 ) );
+  assert( tracking.matches( "utm%5Fmedium", 12 ) );
+  assert( tracking.matches( "fbclid", 6 ) );
+  assert( !tracking.matches( "fbclid2", 7 ) );
+  assert( !tracking.matches( "utm", 3 ) );
+  assert( !tracking.matches( "id", 2 ) );
+
+  /* Kept pairs retain their original bytes */
+  assert( filtered( tracking, "https://example.com/a?utm_source=x&id=%41+b&fbclid=y#top" ) ==
+          "https://example.com/a?id=%41+b#top" );
+  assert( filtered( tracking, "https://example.com/a?q=a%2Cb&utm_medium=mail" ) ==
+          "https://example.com/a?q=a%2Cb" );
+  assert( filtered( tracking, "https://example.com/a?utm_source=x&gclid=1" ) ==
+          "https://example.com/a" );
+  assert( filtered( tracking, "https://example.com/a?utm_source=x#frag?utm_x" ) ==
+          "https://example.com/a#frag?utm_x" );
+  assert( filtered( tracking, "https://example.com/a#x?utm_source=1" ) ==
+          "https://example.com/a#x?utm_source=1" );
+  assert( filtered( tracking, "https://example.com/a?a=1&&b&fbclid" ) ==
+          "https://example.com/a?a=1&&b" );
+  assert( filtered( tracking, "https://example.com/a?&fbclid=1&" ) == "https://example.com/a?&" );
+  assert( filtered( tracking, "/relative?fbclid=1&x=y" ) == "/relative?x=y" );
+
+  std::string untouched = "https://example.com/a?a=1&b=2";
+  assert( !tracking.apply( untouched ) );
+  assert( untouched == "https://example.com/a?a=1&b=2" );
+
+  /* Empty pairs and a bare "?" are not stripped fields */
+  std::string empty = "https://example.com/a?a=1&&b=2";
+  assert( !tracking.apply( empty ) );
+  assert( empty == "https://example.com/a?a=1&&b=2" );
+
+  std::string bare = "http://x/?";
+  assert( !tracking.apply( bare ) );
+  assert( bare == "http://x/?" );
+
+  /* Separate output buffer */
+  std::string source = "http://a/?utm_a=1&k=v";
+  std::string out( source.size( ), '\0' );
+  out.resize( tracking.apply( source.data( ), source.size( ), &out[ 0 ] ) );
+  assert( out == "http://a/?k=v" );
+  assert( source == "http://a/?utm_a=1&k=v" );
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#undef NDEBUG
+#include "uri/form.hh"
+#include "uri/uri.hh"
+#include <assert.h>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+typedef std::vector< std::pair< std::string, std::string > > Pairs;
+
+static Pairs decode( const std::string &body, size_t chunk, bool plus = true ) {
+  Pairs       pairs;
+  FormDecoder decoder(
+    [&pairs]( const std::string &key, const std::string &value ) {
+      pairs.emplace_back( key, value );
+      return true;
+    },
+    0, plus );
+
+  for ( size_t pos = 0; pos < body.size( ); pos += chunk ) {
+    assert( decoder.feed( body.substr( pos, chunk ) ) );
+  }
+  assert( decoder.finish( ) );
+  return pairs;
+}
+
+int main( int argc, char *argv[] ) {
+  std::string body     = "name=J%C3%BCrgen+M%c3%bcller&empty=&flag&&q=a%2Bb%3Dc=d&last=%2";
+  Pairs       expected = { { "name", "J\xC3\xBCrgen M\xC3\xBCller" },
+                           { "empty", "" },
+                           { "flag", "" },
+                           { "q", "a+b=c=d" },
+                           { "last", "" } };
+
+  /* Every chunk size, so every split point (including inside "%2" escapes) is covered */
+  for ( size_t chunk = 1; chunk <= body.size( ); ++chunk ) {
+    assert( decode( body, chunk ) == expected );
+  }
+
+  assert( decode( "a=b+c", 2, false ) == ( Pairs{ { "a", "b+c" } } ) );
+  assert( decode( "q=some%20query%20value", 3 ) ==
+          ( Pairs{ { "q", Uri::unescape( "some%20query%20value" ) } } ) );
+
+  /* Field limit bounds memory */
+  FormDecoder limited( []( const std::string &, const std::string & ) { return true; }, 4 );
+  assert( limited.feed( "ab=cd&" ) );
+  assert( !limited.feed( "abc=de" "fgh" ) );
+  limited.reset( );
+  assert( limited.feed( "x=1" ) && limited.finish( ) );
+
+  /* Callback can stop decoding */
+  size_t      seen = 0;
+  FormDecoder stopping( [&seen]( const std::string &, const std::string & ) {
+    return ++seen < 2;
+  } );
+  assert( !stopping.feed( "a=1&b=2&c=3" ) );
+  assert( seen == 2 );
+
+  /* Encoder round trip through small buffers */
+  std::string encoded;
+  {
+    auto sink = [&encoded]( const char *data, size_t size ) {
+      encoded.append( data, size );
+    };
+    FormEncoder encoder( sink, 8 );
+    for ( auto &pair : expected ) {
+      encoder.add( pair.first, pair.second );
+    }
+    encoder.add( "sym", "a&b=c+d %" );
+  }
+
+  Pairs roundTrip = expected;
+  roundTrip.emplace_back( "sym", "a&b=c+d %" );
+  assert( encoded.find( "sym=a%26b%3Dc%2Bd+%25" ) != std::string::npos );
+  assert( decode( encoded, 5 ) == roundTrip );
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#undef NDEBUG
+#include "uri/pattern.hh"
+#include <assert.h>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+static std::vector< size_t > matching( const UriPatternSet &set, const std::string &uri ) {
+  std::vector< size_t > ids;
+  set.match( uri, ids );
+  return ids;
+}
+
+int main( int argc, char *argv[] ) {
+  UriPatternSet set;
+
+  size_t admin  = set.add( "*.example.com/admin/*" );
+  size_t login  = set.add( "https://*/login?next=*" );
+  size_t scheme = set.add( "ftp://*" );
+  size_t exact  = set.add( "http://www.example.com/" );
+  size_t any    = set.add( "*" );
+  size_t star   = set.add( "*.example.com/a\\*b" );
+
+  typedef std::vector< size_t > Ids;
+
+  assert( set.size( ) == 6 );
+  assert( matching( set, "https://www.example.com/admin/users" ) == ( Ids{ admin, any } ) );
+  assert( matching( set, "https://WWW.Example.COM/admin/" ) == ( Ids{ admin, any } ) );
+  assert( matching( set, "https://example.com/admin/users" ) == ( Ids{ any } ) );
+  assert( matching( set, "https://a.b/login?next=/home" ) == ( Ids{ login, any } ) );
+  assert( matching( set, "http://a.b/login?next=/home" ) == ( Ids{ any } ) );
+  assert( matching( set, "https://a.b/login" ) == ( Ids{ any } ) );
+  assert( matching( set, "FTP://mirror.org/pub" ) == ( Ids{ scheme, any } ) );
+  assert( matching( set, "http://www.example.com/?x=1" ) == ( Ids{ exact, any } ) );
+  assert( matching( set, "http://www.example.com/a*b" ) == ( Ids{ any, star } ) );
+  assert( matching( set, "http://www.example.com/axb" ) == ( Ids{ any } ) );
+
+  /* "://" past the host belongs to the path or query, not to a scheme */
+  size_t next = set.add( "*.example.com/login?next=https://*" );
+  assert( matching( set, "https://www.example.com/login?next=https://evil.com" ) ==
+          ( Ids{ login, any, next } ) );
+  assert( matching( set, "http://www.example.com/login?next=https://evil.com" ) ==
+          ( Ids{ any, next } ) );
+  assert( matching( set, "http://www.example.com/login?next=http://evil.com" ) == ( Ids{ any } ) );
+
+  std::vector< size_t > ids;
+  auto uri = std::shared_ptr< Uri >( Uri::parse( "https://intranet.example.com/admin/x" ) );
+  assert( set.match( *uri, ids ) );
+  assert( ids == ( Ids{ admin, any } ) );
+
+  /* Scale: one pass regardless of the number of patterns */
+  UriPatternSet large;
+
+  for ( int index = 0; index < 20000; ++index ) {
+    large.add( "*.host" + std::to_string( index ) + ".com/p/*" );
+  }
+  large.add( "*/needle" );
+
+  assert( matching( large, "http://www.host12345.com/p/q" ) == ( Ids{ 12345 } ) );
+  assert( matching( large, "http://www.host7.com/needle" ) == ( Ids{ 20000 } ) );
+  assert( matching( large, "http://www.host7.org/p/q" ).empty( ) );
+
+  /* Thousands of distinct hosts, matched from several threads at once */
+  std::vector< std::thread > threads;
+
+  for ( int thread = 0; thread < 4; ++thread ) {
+    threads.emplace_back( [&large, thread]( ) {
+      for ( int index = thread; index < 20000; index += 4 ) {
+        std::string host = "www.host" + std::to_string( index ) + ".com";
+
+        assert( matching( large, "http://" + host + "/p/" + std::to_string( index ) ) ==
+                ( Ids{ static_cast< size_t >( index ) } ) );
+        assert( matching( large, "http://" + host + "/q" ).empty( ) );
+        assert( matching( large, "http://host" + std::to_string( index ) + ".com/p/" ).empty( ) );
+      }
+    } );
+  }
+  for ( auto &thread : threads ) {
+    thread.join( );
+  }
+
+  /* Globs that fan out into every DFA state; the bounded cache is flushed mid-component */
+  UriPatternSet infix;
+
+  for ( int index = 0; index < 3000; ++index ) {
+    infix.add( "*/*/item" + std::to_string( index ) + "/*" );
+  }
+  for ( int index = 0; index < 3000; ++index ) {
+    std::string item = std::to_string( index );
+
+    assert( matching( infix, "http://h/a/b/item" + item + "/c" ) ==
+            ( Ids{ static_cast< size_t >( index ) } ) );
+    assert( matching( infix, "http://h/item" + item + "/c" ).empty( ) );
+  }
+
+  bool thrown = false;
+  try {
+    set.add( "" );
+  } catch ( std::runtime_error &ex ) {
+    thrown = true;
+  }
+  assert( thrown );
+
+  return 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#undef NDEBUG
+#include "uri/template.hh"
+#include <assert.h>
+#include <iostream>
+#include <memory>
+
+static UriTemplate::Variables variables = {
+  { "count", UriTemplate::Value::List{ "one", "two", "three" } },
+  { "dom", UriTemplate::Value::List{ "example", "com" } },
+  { "dub", "me/too" },
+  { "hello", "Hello World!" },
+  { "half", "50%" },
+  { "var", "value" },
+  { "who", "fred" },
+  { "base", "http://example.com/home/" },
+  { "path", "/foo/bar" },
+  { "list", UriTemplate::Value::List{ "red", "green", "blue" } },
+  { "keys", UriTemplate::Value::Map{ { "semi", ";" }, { "dot", "." }, { "comma", "," } } },
+  { "v", "6" },
+  { "x", "1024" },
+  { "y", "768" },
+  { "empty", "" },
+  { "empty_keys", UriTemplate::Value::Map{ } },
+};
+
+static void verify( const std::string &tmpl, const std::string &expected ) {
+  std::string result = UriTemplate( tmpl ).expand( variables );
+
+  std::cout << tmpl << " -> " << result << "\n";
+  assert( result == expected );
+}
+
+int main( int argc, char *argv[] ) {
+  /* RFC 6570 section 3.2 examples */
+  verify( "{var}", "value" );
+  verify( "{hello}", "Hello%20World%21" );
+  verify( "{half}", "50%25" );
+  verify( "O{empty}X", "OX" );
+  verify( "O{undef}X", "OX" );
+  verify( "{x,y}", "1024,768" );
+  verify( "{x,hello,y}", "1024,Hello%20World%21,768" );
+  verify( "?{x,empty}", "?1024," );
+  verify( "?{x,undef}", "?1024" );
+  verify( "{var:3}", "val" );
+  verify( "{var:30}", "value" );
+  verify( "{list}", "red,green,blue" );
+  verify( "{list*}", "red,green,blue" );
+  verify( "{keys}", "semi,%3B,dot,.,comma,%2C" );
+  verify( "{keys*}", "semi=%3B,dot=.,comma=%2C" );
+  verify( "{+var}", "value" );
+  verify( "{+hello}", "Hello%20World!" );
+  verify( "{+half}", "50%25" );
+  verify( "{base}index", "http%3A%2F%2Fexample.com%2Fhome%2Findex" );
+  verify( "{+base}index", "http://example.com/home/index" );
+  verify( "{+path}/here", "/foo/bar/here" );
+  verify( "here?ref={+path}", "here?ref=/foo/bar" );
+  verify( "{+path:6}/here", "/foo/b/here" );
+  verify( "{+keys*}", "semi=;,dot=.,comma=," );
+  verify( "{#var}", "#value" );
+  verify( "{#hello}", "#Hello%20World!" );
+  verify( "{#list*}", "#red,green,blue" );
+  verify( "X{.var}", "X.value" );
+  verify( "X{.list*}", "X.red.green.blue" );
+  verify( "www{.dom*}", "www.example.com" );
+  verify( "{/var,x}/here", "/value/1024/here" );
+  verify( "{/list*,path:4}", "/red/green/blue/%2Ffoo" );
+  verify( "{/keys*}", "/semi=%3B/dot=./comma=%2C" );
+  verify( "{;x,y,empty}", ";x=1024;y=768;empty" );
+  verify( "{;list}", ";list=red,green,blue" );
+  verify( "{;list*}", ";list=red;list=green;list=blue" );
+  verify( "{;keys*}", ";semi=%3B;dot=.;comma=%2C" );
+  verify( "{?x,y,empty}", "?x=1024&y=768&empty=" );
+  verify( "{?list}", "?list=red,green,blue" );
+  verify( "{?list*}", "?list=red&list=green&list=blue" );
+  verify( "{?keys*}", "?semi=%3B&dot=.&comma=%2C" );
+  verify( "?fixed=yes{&x}", "?fixed=yes&x=1024" );
+  verify( "{&var:3}", "&var=val" );
+  verify( "{?empty_keys*}", "" );
+  verify( "{count}", "one,two,three" );
+  verify( "{/count*}", "/one/two/three" );
+  verify( "a b{var}", "a%20b" "value" );
+
+  /* Malformed templates */
+  for ( auto &&bad : { "{var", "var}", "{}", "{=var}", "{var:0}", "{var:10000}", "{.a..b}" } ) {
+    bool thrown = false;
+    try {
+      UriTemplate tmpl( bad );
+    } catch ( std::runtime_error &ex ) {
+      thrown = true;
+    }
+    assert( thrown );
+  }
+
+  /* Index bound expansion and parsed output */
+  UriTemplate tmpl( "https://{host}/v1/users/{id}{?fields*}" );
+
+  assert( tmpl.variables( ).size( ) == 3 );
+  assert( tmpl.variable( "id" ) == 1 );
+  assert( tmpl.variable( "missing" ) == -1 );
+
+  std::string out = "prefix:";
+  std::vector< UriTemplate::Value > values = {
+    "api.example.com", "42", UriTemplate::Value::List{ "name", "email" } };
+
+  assert( tmpl.expand( values, out ) == 60 );
+  assert( out == "prefix:https://api.example.com/v1/users/42?fields=name&fields=email" );
+
+  auto uri = std::shared_ptr< Uri >( tmpl.expandUri( { { "host", "api.example.com" },
+                                                      { "id", "42" } } ) );
+  assert( uri->host( ) == "api.example.com" );
+  assert( uri->resource( ) == "/v1/users/42" );
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2017-2019, Thomas Santanello
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#undef NDEBUG
+#include "uri/uriset.hh"
+#include <algorithm>
+#include <assert.h>
+#include <iostream>
+#include <memory>
+#include <set>
+
+int main( int argc, char *argv[] ) {
+  UriSet::Builder builder;
+  std::set< std::string > reference;
+
+  for ( int host = 0; host < 50; ++host ) {
+    for ( int page = 0; page < 200; ++page ) {
+      std::string uri = "https://www.site" + std::to_string( host ) + ".example.com/articles/" +
+                        std::to_string( page / 10 ) + "/page-" + std::to_string( page ) +
+                        ".html?ref=feed";
+      builder.add( uri );
+      reference.insert( uri );
+    }
+  }
+
+  builder.add( "mailto:jerk@wad.com" );
+  builder.add( "https://www.site1.example.com/articles/0/page-0.html?ref=feed" ); // duplicate
+  builder.add( "http://a.com/" );
+  builder.add( "http://a.com:8080/" );
+  builder.add( "http://a.com.evil/" );
+  reference.insert( "mailto:jerk@wad.com" );
+  reference.insert( "http://a.com/" );
+  reference.insert( "http://a.com:8080/" );
+  reference.insert( "http://a.com.evil/" );
+
+  std::unique_ptr< Uri > parsed( Uri::parse( "http://www.google.com/?q=a" ) );
+  builder.add( *parsed );
+  reference.insert( "http://www.google.com/?q=a" );
+
+  UriSet set = builder.build( );
+
+  assert( set.size( ) == reference.size( ) );
+
+  for ( auto &uri : reference ) {
+    assert( set.contains( uri ) );
+  }
+  assert( !set.contains( "https://www.site1.example.com/articles/0/page-0.html" ) );
+  assert( !set.contains( "https://www.site1.example.com/" ) );
+  assert( !set.contains( "https://www.site99.example.com/articles/0/page-0.html?ref=feed" ) );
+  assert( !set.contains( "mailto:someone@wad.com" ) );
+  assert( !set.contains( "" ) );
+
+  /* Iteration decodes every URI exactly once */
+  std::set< std::string > iterated;
+  for ( auto &uri : set ) {
+    assert( iterated.insert( uri ).second );
+  }
+  assert( iterated == reference );
+
+  auto first = set.begin( );
+  std::unique_ptr< Uri > uri( first.parse( ) );
+  assert( uri->toString( ) == *first );
+
+  /* Prefix scans */
+  std::vector< std::string > found;
+  auto collect = [&found]( const std::string &uri ) {
+    found.push_back( uri );
+    return true;
+  };
+
+  assert( set.scan( "https://www.site7.example.com/articles/1/", collect ) == 10 );
+  for ( auto &uri : found ) {
+    assert( uri.compare( 0, 41, "https://www.site7.example.com/articles/1/" ) == 0 );
+  }
+
+  found.clear( );
+  assert( set.scan( "https://www.site7.", collect ) == 200 );
+  found.clear( );
+  assert( set.scan( "https://www.site1", collect ) == 11 * 200 );
+  found.clear( );
+  assert( set.scan( "http://a.com", collect ) == 3 );
+  found.clear( );
+  assert( set.scan( "http://a.com/", collect ) == 1 );
+  found.clear( );
+  assert( set.scan( "mail", collect ) == 1 );
+  found.clear( );
+  assert( set.scan( "mailto:jerk", collect ) == 1 );
+  found.clear( );
+  assert( set.scan( "gopher:", collect ) == 0 );
+  assert( set.scan( "", []( const std::string & ) { return false; } ) == 1 );
+
+  /* Compression */
+  size_t plain = 0;
+  for ( auto &uri : reference ) {
+    plain += sizeof( std::string ) + uri.capacity( ) + 1;
+  }
+  std::cout << "UriSet " << set.memory( ) << " bytes; strings " << plain << " bytes\n";
+  assert( set.memory( ) * 10 < plain );
+
+  UriSet empty = UriSet::Builder( ).build( );
+  assert( empty.empty( ) );
+  assert( empty.begin( ) == empty.end( ) );
+  assert( !empty.contains( "http://a.com/" ) );
+
+  return 0;
+}